@@ -0,0 +1,747 @@
+#include "CloudFile.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <boost/cstdint.hpp>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#if defined(__cpp_lib_to_chars)
+#define SCD_FROM_CHARS
+#endif
+#endif
+
+namespace SCD
+{
+  namespace
+  {
+    bool isBlank(char c)
+    {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    const char* skipBlanks(const char* p, const char* end)
+    {
+      while (p != end && isBlank(*p))
+        ++p;
+      return p;
+    }
+
+    const char* tokenEnd(const char* p, const char* end)
+    {
+      while (p != end && !isBlank(*p) && *p != '\n')
+        ++p;
+      return p;
+    }
+
+    //the token [p,end) is entirely a number, parsed as scanf does
+    bool parseDouble(const char* p, const char* end, double& d)
+    {
+      if (p != end && *p == '+' && end-p > 1 && p[1] != '-')
+        ++p;
+#ifdef SCD_FROM_CHARS
+      std::from_chars_result r = std::from_chars(p, end, d);
+      return r.ec == std::errc() && r.ptr == end;
+#else
+      char buffer[64];
+      if (p == end || end-p >= int(sizeof(buffer)))
+        return false;
+      std::memcpy(buffer, p, end-p);
+      buffer[end-p] = 0;
+      char* last;
+      d = std::strtod(buffer, &last);
+      return last == buffer+(end-p);
+#endif
+    }
+
+    bool parseInt(const char* p, const char* end, long& n)
+    {
+#ifdef SCD_FROM_CHARS
+      std::from_chars_result r = std::from_chars(p, end, n);
+      return r.ec == std::errc() && r.ptr == end;
+#else
+      char buffer[32];
+      if (p == end || end-p >= int(sizeof(buffer)))
+        return false;
+      std::memcpy(buffer, p, end-p);
+      buffer[end-p] = 0;
+      char* last;
+      n = std::strtol(buffer, &last, 10);
+      return last == buffer+(end-p);
+#endif
+    }
+
+    std::string token(const char* p, const char* end)
+    {
+      return std::string(p, tokenEnd(p, end));
+    }
+
+    //next header number, possibly on the next lines
+    bool headerInt(const char*& p, const char* end, long& line, long& n, std::string& error)
+    {
+      for (p = skipBlanks(p, end); p != end && *p == '\n'; p = skipBlanks(p+1, end))
+        ++line;
+      if (p == end)
+      {
+        error = "unexpected end of file";
+        return false;
+      }
+      const char* q = tokenEnd(p, end);
+      if (!parseInt(p, q, n))
+      {
+        error = "expected an integer, found '" + std::string(p, q) + "'";
+        return false;
+      }
+      p = q;
+      return true;
+    }
+
+    //line of three coordinates
+    bool parsePoint(const char* p, const char* end, vector3d& v, std::string& error)
+    {
+      for (int m=0; m<3; ++m)
+      {
+        p = skipBlanks(p, end);
+        const char* q = tokenEnd(p, end);
+        if (p == q)
+        {
+          std::ostringstream os;
+          os << "expected 3 coordinates, found " << m;
+          error = os.str();
+          return false;
+        }
+        if (!parseDouble(p, q, v[m]))
+        {
+          error = "expected a coordinate, found '" + std::string(p, q) + "'";
+          return false;
+        }
+        p = q;
+      }
+      p = skipBlanks(p, end);
+      if (p != end)
+      {
+        error = "unexpected '" + token(p, end) + "' after the 3 coordinates";
+        return false;
+      }
+      return true;
+    }
+
+    //lines of the points, [_begin,_end) ends after a '\n' or at the end of the file
+    struct chunk
+    {
+      const char*	_begin;
+      const char*	_end;
+      long		_lines;
+      long		_points;			//non blank lines
+      long		_firstLine;
+      long		_firstPoint;
+      long		_errorLine;			//-1 if no error
+      std::string	_error;
+    };
+
+    void countLines(chunk& c)
+    {
+      c._lines = 0;
+      c._points = 0;
+      for (const char* p = c._begin; p != c._end; )
+      {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', c._end-p));
+        const char* last = eol?eol:c._end;
+        if (skipBlanks(p, last) != last)
+          ++c._points;
+        if (eol)
+          ++c._lines;
+        p = eol?eol+1:c._end;
+      }
+    }
+
+    void parseLines(chunk& c, std::vector<vector3d>& points)
+    {
+      long line = c._firstLine;
+      long i = c._firstPoint;
+      for (const char* p = c._begin; p != c._end && i < long(points.size()); ++line)
+      {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', c._end-p));
+        const char* last = eol?eol:c._end;
+        if (skipBlanks(p, last) != last)
+        {
+          if (!parsePoint(p, last, points[i], c._error))
+          {
+            c._errorLine = line;
+            return;
+          }
+          ++i;
+        }
+        p = eol?eol+1:c._end;
+      }
+    }
+  }
+
+  bool readCloud(std::vector<vector3d>& points, const std::string& filename, int threads, std::ostream& log)
+  {
+    points.clear();
+    MappedFile file(filename);
+    if (!file.isOpen())
+    {
+      log << "unable to open file " << filename << std::endl;
+      return false;
+    }
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+    long line = 1;
+    long dimension, count;
+    std::string error;
+    bool valid = headerInt(p, end, line, dimension, error);
+    if (valid && dimension != 3)
+    {
+      std::ostringstream os;
+      os << "dimension " << dimension << ", expected 3";
+      error = os.str();
+      valid = false;
+    }
+    if (valid && headerInt(p, end, line, count, error))
+    {
+      p = skipBlanks(p, end);
+      if (count < 0)
+      {
+        error = "negative number of points";
+        valid = false;
+      }
+      else if (p != end && *p != '\n')
+      {
+        error = "unexpected '" + token(p, end) + "' after the number of points";
+        valid = false;
+      }
+    }
+    else
+      valid = false;
+    if (!valid)
+    {
+      log << filename << ":" << line << ": " << error << std::endl;
+      return false;
+    }
+    if (p != end)
+    {
+      ++p;
+      ++line;
+    }
+
+    //chunks of about the same size, on the lines
+    const std::size_t minChunkSize = 1 << 20;
+    std::size_t nbChunks = (threads > 1)?std::min(std::size_t(4*threads), std::size_t(end-p)/minChunkSize + 1):1;
+    std::vector<chunk> chunks(nbChunks);
+    const char* begin = p;
+    for (std::size_t k=0; k<nbChunks; ++k)
+    {
+      chunks[k]._begin = begin;
+      const char* last = (k+1 == nbChunks)?end:std::max(begin, p + (end-p)/nbChunks*(k+1));
+      const char* eol = (last == end)?0:static_cast<const char*>(std::memchr(last, '\n', end-last));
+      chunks[k]._end = begin = eol?eol+1:end;
+      chunks[k]._errorLine = -1;
+    }
+
+    int n = int(nbChunks);
+#pragma omp parallel for schedule(static) num_threads(threads) if(n > 1)
+    for (int k=0; k<n; ++k)
+      countLines(chunks[k]);
+
+    long nbPoints = 0;
+    for (std::size_t k=0; k<nbChunks; ++k)
+    {
+      chunks[k]._firstLine = line;
+      chunks[k]._firstPoint = nbPoints;
+      line += chunks[k]._lines;
+      nbPoints += chunks[k]._points;
+    }
+    if (nbPoints < count)
+    {
+      log << filename << ":" << line << ": end of file after " << nbPoints << " points, " << count << " expected" << std::endl;
+      return false;
+    }
+
+    //the lines after the last point are ignored
+    points.resize(count);
+#pragma omp parallel for schedule(static) num_threads(threads) if(n > 1)
+    for (int k=0; k<n; ++k)
+      parseLines(chunks[k], points);
+
+    for (std::size_t k=0; k<nbChunks; ++k)
+    {
+      if (chunks[k]._errorLine >= 0)
+      {
+        log << filename << ":" << chunks[k]._errorLine << ": " << chunks[k]._error << std::endl;
+        points.clear();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  namespace
+  {
+    void readError(std::ostream& log, const std::string& filename, long line, const std::string& error)
+    {
+      log << filename << ":" << line << ": " << error << std::endl;
+    }
+
+    //VRML token : a word, a string or one of {}[], the commas being white spaces
+    bool nextToken(const char*& p, const char* end, long& line, const char*& first, const char*& last)
+    {
+      for (;;)
+      {
+        while (p != end && (isBlank(*p) || *p == ',' || *p == '\n'))
+        {
+          if (*p == '\n')
+            ++line;
+          ++p;
+        }
+        if (p == end || *p != '#')
+          break;
+        while (p != end && *p != '\n')
+          ++p;
+      }
+      if (p == end)
+        return false;
+      first = p;
+      if (*p == '{' || *p == '}' || *p == '[' || *p == ']')
+        ++p;
+      else if (*p == '"')
+      {
+        for (++p; p != end && *p != '"'; ++p)
+        {
+          if (*p == '\\' && p+1 != end)
+            ++p;
+          else if (*p == '\n')
+            ++line;
+        }
+        if (p != end)
+          ++p;
+      }
+      else
+      {
+        while (p != end && !isBlank(*p) && *p != ',' && *p != '\n' && *p != '#'
+               && *p != '{' && *p != '}' && *p != '[' && *p != ']')
+          ++p;
+      }
+      last = p;
+      return true;
+    }
+
+    bool isToken(const char* first, const char* last, const char* word)
+    {
+      return std::size_t(last-first) == std::strlen(word) && std::strncmp(first, word, last-first) == 0;
+    }
+
+    //the points of the Coordinate nodes, whatever their transformations
+    bool readVRML(std::vector<vector3d>& points, const MappedFile& file, const std::string& filename, std::ostream& log)
+    {
+      const char* p = file.data();
+      const char* end = p + file.size();
+      long line = 1;
+      const char* first;
+      const char* last;
+      std::string previous;
+      std::vector<std::string> nodes;			//type (or name) of the nodes the tokens are in
+      while (nextToken(p, end, line, first, last))
+      {
+        if (*first == '{')
+          nodes.push_back(previous);
+        else if (*first == '}' && !nodes.empty())
+          nodes.pop_back();
+        else if (isToken(first, last, "point") && !nodes.empty() && nodes.back() == "Coordinate")
+        {
+          if (!nextToken(p, end, line, first, last) || *first != '[')
+          {
+            readError(log, filename, line, "expected '[' after point");
+            return false;
+          }
+          std::vector<double> coordinates;
+          for (;;)
+          {
+            if (!nextToken(p, end, line, first, last))
+            {
+              readError(log, filename, line, "unexpected end of file in the point field");
+              return false;
+            }
+            if (*first == ']')
+              break;
+            double d;
+            if (!parseDouble(first, last, d))
+            {
+              readError(log, filename, line, "expected a coordinate, found '" + std::string(first, last) + "'");
+              return false;
+            }
+            coordinates.push_back(d);
+          }
+          if (coordinates.size() % 3 != 0)
+          {
+            readError(log, filename, line, "the number of coordinates of the point field is not a multiple of 3");
+            return false;
+          }
+          for (std::size_t i=0; i<coordinates.size(); i+=3)
+            points.push_back(vector3d(coordinates[i], coordinates[i+1], coordinates[i+2]));
+        }
+        previous.assign(first, last);
+      }
+      return true;
+    }
+
+    //the first three numbers after the keyword of the lines starting with it : the v lines of OBJ (whose w and
+    //colours are ignored), the vertex lines of ascii STL
+    bool readKeywordLines(std::vector<vector3d>& points, const MappedFile& file, const std::string& filename,
+                          const char* keyword, std::ostream& log)
+    {
+      const char* p = file.data();
+      const char* end = p + file.size();
+      for (long line = 1; p != end; ++line)
+      {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end-p));
+        const char* last = eol?eol:end;
+        const char* q = skipBlanks(p, last);
+        const char* k = tokenEnd(q, last);
+        if (isToken(q, k, keyword))
+        {
+          vector3d v;
+          std::string error;
+          for (int m=0; m<3 && error.empty(); ++m)
+          {
+            q = skipBlanks(k, last);
+            k = tokenEnd(q, last);
+            if (q == k)
+              error = "expected 3 coordinates";
+            else if (!parseDouble(q, k, v[m]))
+              error = "expected a coordinate, found '" + std::string(q, k) + "'";
+          }
+          if (!error.empty())
+          {
+            readError(log, filename, line, error);
+            return false;
+          }
+          points.push_back(v);
+        }
+        p = eol?eol+1:end;
+      }
+      return true;
+    }
+
+    boost::uint64_t getBytes(const char* p, int size, bool bigEndian)
+    {
+      boost::uint64_t v = 0;
+      for (int k=0; k<size; ++k)
+        v = (v << 8) | boost::uint64_t((unsigned char)p[bigEndian?k:size-1-k]);
+      return v;
+    }
+
+    float getFloat(const char* p, bool bigEndian)
+    {
+      boost::uint32_t v = boost::uint32_t(getBytes(p, 4, bigEndian));
+      float f;
+      std::memcpy(&f, &v, sizeof(f));
+      return f;
+    }
+
+    //binary STL : 80 bytes of header, the number of facets, then the facets (normal, 3 vertices, attribute)
+    bool isBinarySTL(const MappedFile& file)
+    {
+      return file.size() >= 84 && file.size() == 84 + 50*getBytes(file.data()+80, 4, false);
+    }
+
+    bool readSTL(std::vector<vector3d>& points, const MappedFile& file, const std::string& filename, std::ostream& log)
+    {
+      if (!isBinarySTL(file))
+        return readKeywordLines(points, file, filename, "vertex", log);
+      std::size_t n = std::size_t(getBytes(file.data()+80, 4, false));
+      points.reserve(3*n);
+      for (std::size_t i=0; i<n; ++i)
+      {
+        const char* facet = file.data() + 84 + 50*i;
+        for (int k=1; k<=3; ++k)
+        {
+          const char* v = facet + 12*k;
+          points.push_back(vector3d(getFloat(v, false), getFloat(v+4, false), getFloat(v+8, false)));
+        }
+      }
+      return true;
+    }
+
+    //size in bytes of a PLY scalar type, 0 if it is unknown
+    int plyTypeSize(const std::string& type)
+    {
+      if (type == "char" || type == "uchar" || type == "int8" || type == "uint8")
+        return 1;
+      if (type == "short" || type == "ushort" || type == "int16" || type == "uint16")
+        return 2;
+      if (type == "int" || type == "uint" || type == "float" || type == "int32" || type == "uint32" || type == "float32")
+        return 4;
+      if (type == "double" || type == "float64")
+        return 8;
+      return 0;
+    }
+
+    double plyValue(const char* p, const std::string& type, bool bigEndian)
+    {
+      int size = plyTypeSize(type);
+      boost::uint64_t v = getBytes(p, size, bigEndian);
+      if (type == "float" || type == "float32")
+        return getFloat(p, bigEndian);
+      if (type == "double" || type == "float64")
+      {
+        double d;
+        std::memcpy(&d, &v, sizeof(d));
+        return d;
+      }
+      if (type[0] == 'u')
+        return double(v);
+      //sign extension
+      boost::uint64_t sign = boost::uint64_t(1) << (8*size-1);
+      return double(boost::int64_t((v ^ sign) - sign));
+    }
+
+    struct plyElement
+    {
+      std::string					_name;
+      long							_count;
+      std::vector<std::string>		_types;			//of the properties, "list" for the lists
+      std::vector<std::string>		_names;
+    };
+
+    bool readPLY(std::vector<vector3d>& points, const MappedFile& file, const std::string& filename, std::ostream& log)
+    {
+      const char* p = file.data();
+      const char* end = p + file.size();
+      long line = 0;
+      std::string format;
+      std::vector<plyElement> elements;
+      bool header = true;
+      while (header)
+      {
+        ++line;
+        if (p == end)
+        {
+          readError(log, filename, line, "unexpected end of file in the header");
+          return false;
+        }
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end-p));
+        const char* last = eol?eol:end;
+        std::istringstream is(std::string(p, last));
+        p = eol?eol+1:end;
+        std::string keyword;
+        is >> keyword;
+        if (keyword == "format")
+          is >> format;
+        else if (keyword == "element")
+        {
+          elements.push_back(plyElement());
+          is >> elements.back()._name >> elements.back()._count;
+        }
+        else if (keyword == "property" && !elements.empty())
+        {
+          std::string type, name;
+          is >> type;
+          if (type == "list")
+          {
+            std::string countType, itemType;
+            is >> countType >> itemType;
+          }
+          else if (plyTypeSize(type) == 0)
+          {
+            readError(log, filename, line, "unknown property type '" + type + "'");
+            return false;
+          }
+          is >> name;
+          elements.back()._types.push_back(type);
+          elements.back()._names.push_back(name);
+        }
+        else if (keyword == "end_header")
+          header = false;
+      }
+      if (format != "ascii" && format != "binary_little_endian" && format != "binary_big_endian")
+      {
+        readError(log, filename, line, "unknown format '" + format + "'");
+        return false;
+      }
+      bool bigEndian = (format == "binary_big_endian");
+
+      //the elements before the vertices are skipped : they must have a fixed size in binary
+      std::size_t e = 0;
+      for (; e<elements.size() && elements[e]._name != "vertex"; ++e)
+      {
+        int size = 0;
+        for (std::size_t k=0; k<elements[e]._types.size(); ++k)
+        {
+          if (elements[e]._types[k] == "list" && format != "ascii")
+          {
+            readError(log, filename, line, "the element " + elements[e]._name + " with a list before the vertices is not supported");
+            return false;
+          }
+          size += plyTypeSize(elements[e]._types[k]);
+        }
+        for (long i=0; i<elements[e]._count && p != end; ++i)
+        {
+          if (format == "ascii")
+          {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', end-p));
+            p = eol?eol+1:end;
+            ++line;
+          }
+          else
+            p += std::min(std::size_t(size), std::size_t(end-p));
+        }
+      }
+      if (e == elements.size())
+      {
+        readError(log, filename, line, "no vertex element");
+        return false;
+      }
+
+      const plyElement& vertex = elements[e];
+      int coordinates[3] = {-1, -1, -1};
+      std::vector<int> offsets;
+      int size = 0;
+      for (std::size_t k=0; k<vertex._types.size(); ++k)
+      {
+        if (vertex._types[k] == "list")
+        {
+          readError(log, filename, line, "list property of the vertices");
+          return false;
+        }
+        for (int m=0; m<3; ++m)
+        {
+          if (vertex._names[k] == std::string(1, char('x'+m)))
+            coordinates[m] = int(k);
+        }
+        offsets.push_back(size);
+        size += plyTypeSize(vertex._types[k]);
+      }
+      if (coordinates[0] < 0 || coordinates[1] < 0 || coordinates[2] < 0)
+      {
+        readError(log, filename, line, "the vertices have no x, y and z properties");
+        return false;
+      }
+
+      points.reserve(points.size() + vertex._count);
+      if (format != "ascii")
+      {
+        if (vertex._count > long((end-p)/size))
+        {
+          readError(log, filename, line, "unexpected end of file in the vertices");
+          return false;
+        }
+        for (long i=0; i<vertex._count; ++i, p+=size)
+        {
+          vector3d v;
+          for (int m=0; m<3; ++m)
+            v[m] = plyValue(p+offsets[coordinates[m]], vertex._types[coordinates[m]], bigEndian);
+          points.push_back(v);
+        }
+        return true;
+      }
+
+      for (long i=0; i<vertex._count; ++i)
+      {
+        ++line;
+        if (p == end)
+        {
+          readError(log, filename, line, "unexpected end of file in the vertices");
+          return false;
+        }
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end-p));
+        const char* last = eol?eol:end;
+        vector3d v;
+        const char* q = p;
+        for (int k=0; k<=std::max(coordinates[0], std::max(coordinates[1], coordinates[2])); ++k)
+        {
+          q = skipBlanks(q, last);
+          const char* t = tokenEnd(q, last);
+          double d;
+          if (q == t || !parseDouble(q, t, d))
+          {
+            readError(log, filename, line, "expected a number, found '" + std::string(q, t) + "'");
+            return false;
+          }
+          for (int m=0; m<3; ++m)
+          {
+            if (coordinates[m] == int(k))
+              v[m] = d;
+          }
+          q = t;
+        }
+        points.push_back(v);
+        p = eol?eol+1:end;
+      }
+      return true;
+    }
+
+    bool hasExtension(const std::string& filename, const char* extension)
+    {
+      std::size_t n = std::strlen(extension);
+      if (filename.size() < n)
+        return false;
+      for (std::size_t k=0; k<n; ++k)
+      {
+        if (std::tolower((unsigned char)filename[filename.size()-n+k]) != extension[k])
+          return false;
+      }
+      return true;
+    }
+
+    PointFileFormat fileFormat(const MappedFile& file, const std::string& filename)
+    {
+      const char* p = file.data();
+      std::size_t size = file.size();
+      if (size >= 5 && std::strncmp(p, "#VRML", 5) == 0)
+        return VRML_FILE;
+      if (size >= 4 && std::strncmp(p, "ply", 3) == 0 && (p[3] == '\n' || p[3] == '\r'))
+        return PLY_FILE;
+      if (isBinarySTL(file) || (size >= 5 && std::strncmp(p, "solid", 5) == 0))
+        return STL_FILE;
+      if (hasExtension(filename, ".obj"))
+        return OBJ_FILE;
+      return CLOUD_FILE;
+    }
+  }
+
+  PointFileFormat pointFileFormat(const std::string& filename)
+  {
+    MappedFile file(filename);
+    return fileFormat(file, filename);
+  }
+
+  bool readPoints(std::vector<vector3d>& points, const std::string& filename, int threads, std::ostream& log)
+  {
+    points.clear();
+    MappedFile file(filename);
+    if (!file.isOpen())
+    {
+      log << "unable to open file " << filename << std::endl;
+      return false;
+    }
+
+    bool read = false;
+    switch (fileFormat(file, filename))
+    {
+    case CLOUD_FILE:
+      return readCloud(points, filename, threads, log);
+    case VRML_FILE:
+      read = readVRML(points, file, filename, log);
+      break;
+    case OBJ_FILE:
+      read = readKeywordLines(points, file, filename, "v", log);
+      break;
+    case PLY_FILE:
+      read = readPLY(points, file, filename, log);
+      break;
+    case STL_FILE:
+      read = readSTL(points, file, filename, log);
+      break;
+    }
+    if (!read)
+      points.clear();
+    return read;
+  }
+}
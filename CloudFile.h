@@ -0,0 +1,42 @@
+/*! \file CloudFile.h
+ *  \brief Declaration file of the reading of the point clouds and of the vertices of the meshes
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_CLOUD_FILE_H
+#define SCD_CLOUD_FILE_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include "vector3.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+
+  //read a cloud in the qhull format of the .qc and .cloud files : the dimension (3), the number of points, and one
+  //point per line. The file is mapped in memory and its lines are parsed in parallel on the given number of threads.
+  //Returns false, with a message on log giving the line of the error, if the file can't be read : points is then empty
+  bool readCloud(std::vector<vector3d>& points, const std::string& filename, int threads = 1, std::ostream& log = std::cout);
+
+  enum PointFileFormat
+  {
+    CLOUD_FILE,				//.qc and .cloud files, see readCloud
+    VRML_FILE,				//the point fields of the Coordinate nodes
+    OBJ_FILE,				//the v lines
+    PLY_FILE,				//the x, y, z properties of the vertex element, binary or ascii
+    STL_FILE				//the vertices of the facets, binary or ascii
+  };
+
+  //format of a file, from its content (and its extension for the OBJ files, which have no header)
+  PointFileFormat pointFileFormat(const std::string& filename);
+  //read the points of a file of any format. The vertices of the meshes are read as they are, with their
+  //duplicates. Returns false, with a message on log giving the line of the error, if the file can't be read
+  bool readPoints(std::vector<vector3d>& points, const std::string& filename, int threads = 1, std::ostream& log = std::cout);
+}
+
+#endif	//SCD_CLOUD_FILE_H
@@ -0,0 +1,281 @@
+#include "ConvexHull.h"
+#include <map>
+#include <limits>
+
+namespace SCD
+{
+
+  ConvexHull::ConvexHull(const std::vector<vector3d>& points):
+    _points(points),
+    _epsilon(0.)
+  {
+  }
+
+  double ConvexHull::distance(int face, int point) const
+  {
+    return _faces[face]._normal%_points[point] - _faces[face]._offset;
+  }
+
+  int ConvexHull::addFace(int a, int b, int c)
+  {
+    Face f;
+    f._v[0] = a;
+    f._v[1] = b;
+    f._v[2] = c;
+    f._adj[0] = f._adj[1] = f._adj[2] = -1;
+    f._normal = (_points[b]-_points[a])^(_points[c]-_points[a]);
+    double n = f._normal.norm();
+    if (n > 0)
+      f._normal /= n;
+    f._offset = f._normal%_points[a];
+    f._alive = true;
+    _faces.push_back(f);
+    return int(_faces.size()) - 1;
+  }
+
+  bool ConvexHull::initialSimplex(int s[4])
+  {
+    unsigned int n = _points.size();
+
+    //extreme points along the axis, the two farthest ones give the first edge
+    int extremes[6] = {0,0,0,0,0,0};
+    for (unsigned int i=0; i<n; ++i)
+    {
+      for (int k=0; k<3; ++k)
+      {
+        if (_points[i][k] < _points[extremes[2*k]][k])
+          extremes[2*k] = i;
+        if (_points[i][k] > _points[extremes[2*k+1]][k])
+          extremes[2*k+1] = i;
+      }
+    }
+    double dmax = 0;
+    for (int i=0; i<6; ++i)
+    {
+      for (int j=i+1; j<6; ++j)
+      {
+        double d = (_points[extremes[i]]-_points[extremes[j]]).normsquared();
+        if (d > dmax)
+        {
+          dmax = d;
+          s[0] = extremes[i];
+          s[1] = extremes[j];
+        }
+      }
+    }
+    if (dmax == 0)
+      return false;
+    _epsilon *= sqrt(dmax);
+
+    //farthest point from the line [s0,s1]
+    vector3d u = _points[s[1]]-_points[s[0]];
+    u.normalize();
+    dmax = 0;
+    for (unsigned int i=0; i<n; ++i)
+    {
+      double d = ((_points[i]-_points[s[0]])^u).norm();
+      if (d > dmax)
+      {
+        dmax = d;
+        s[2] = i;
+      }
+    }
+    if (dmax <= _epsilon)
+      return false;
+
+    //farthest point from the plane [s0,s1,s2]
+    vector3d nrm = (_points[s[1]]-_points[s[0]])^(_points[s[2]]-_points[s[0]]);
+    nrm.normalize();
+    dmax = 0;
+    for (unsigned int i=0; i<n; ++i)
+    {
+      double d = fabs(nrm%(_points[i]-_points[s[0]]));
+      if (d > dmax)
+      {
+        dmax = d;
+        s[3] = i;
+      }
+    }
+    if (dmax <= _epsilon)
+      return false;
+
+    //s3 must be below [s0,s1,s2] for the faces to be counterclockwise
+    if (nrm%(_points[s[3]]-_points[s[0]]) > 0)
+    {
+      int e = s[1];
+      s[1] = s[2];
+      s[2] = e;
+    }
+    return true;
+  }
+
+  void ConvexHull::assignPoint(int point, const std::vector<int>& faces)
+  {
+    double dmax = -std::numeric_limits<double>::max();
+    for (unsigned int i=0; i<faces.size(); ++i)
+    {
+      double d = distance(faces[i], point);
+      if (d > _epsilon)
+      {
+        _faces[faces[i]]._outside.push_back(point);
+        return;
+      }
+      if (d > dmax)
+        dmax = d;
+    }
+    //points close to a face are kept, only the ones clearly inside are discarded
+    if (dmax < -_epsilon)
+      _inside[point] = true;
+  }
+
+  bool ConvexHull::addPoint(int face)
+  {
+    //the farthest point of the outside set is on the hull
+    int apex = -1;
+    double dmax = -std::numeric_limits<double>::max();
+    for (unsigned int i=0; i<_faces[face]._outside.size(); ++i)
+    {
+      double d = distance(face, _faces[face]._outside[i]);
+      if (d > dmax)
+      {
+        dmax = d;
+        apex = _faces[face]._outside[i];
+      }
+    }
+
+    //find the faces seen from the apex, and the horizon around them
+    _visited.resize(_faces.size(), -1);
+    std::vector<int> visible(1, face);
+    std::vector<int> horizonA, horizonB, horizonFace;
+    _visited[face] = apex;
+    for (unsigned int i=0; i<visible.size(); ++i)
+    {
+      const Face& f = _faces[visible[i]];
+      for (int k=0; k<3; ++k)
+      {
+        int g = f._adj[k];
+        if (_visited[g] == apex)
+          continue;
+        if (distance(g, apex) > _epsilon)
+        {
+          _visited[g] = apex;
+          visible.push_back(g);
+        }
+        else
+        {
+          horizonA.push_back(f._v[k]);
+          horizonB.push_back(f._v[(k+1)%3]);
+          horizonFace.push_back(g);
+        }
+      }
+    }
+
+    //build the cone of new faces between the horizon and the apex
+    std::vector<int> newFaces;
+    std::map<int, int> byA, byB;
+    for (unsigned int i=0; i<horizonA.size(); ++i)
+    {
+      int nf = addFace(horizonA[i], horizonB[i], apex);
+      Face& g = _faces[horizonFace[i]];
+      _faces[nf]._adj[0] = horizonFace[i];
+      for (int m=0; m<3; ++m)
+      {
+        if (g._v[m] == horizonB[i] && g._v[(m+1)%3] == horizonA[i])
+          g._adj[m] = nf;
+      }
+      //a horizon which is not a simple loop means the hull is numerically broken
+      if (!byA.insert(std::pair<int, int>(horizonA[i], nf)).second ||
+          !byB.insert(std::pair<int, int>(horizonB[i], nf)).second)
+        return false;
+      newFaces.push_back(nf);
+    }
+    for (unsigned int i=0; i<newFaces.size(); ++i)
+    {
+      Face& f = _faces[newFaces[i]];
+      std::map<int, int>::iterator a = byA.find(f._v[1]);
+      std::map<int, int>::iterator b = byB.find(f._v[0]);
+      if (a == byA.end() || b == byB.end())
+        return false;
+      f._adj[1] = a->second;
+      f._adj[2] = b->second;
+    }
+
+    //the points above the visible faces are given to the new ones
+    for (unsigned int i=0; i<visible.size(); ++i)
+    {
+      std::vector<int> outside;
+      outside.swap(_faces[visible[i]]._outside);
+      _faces[visible[i]]._alive = false;
+      for (unsigned int j=0; j<outside.size(); ++j)
+      {
+        if (outside[j] != apex)
+          assignPoint(outside[j], newFaces);
+      }
+    }
+    return true;
+  }
+
+  bool ConvexHull::compute(double epsilon)
+  {
+    unsigned int n = _points.size();
+    _faces.clear();
+    _visited.clear();
+    _inside.assign(n, false);
+    _epsilon = epsilon;
+
+    int s[4];
+    if (n < 5 || !initialSimplex(s))
+      return false;
+
+    std::vector<int> faces;
+    faces.push_back(addFace(s[0], s[1], s[2]));
+    faces.push_back(addFace(s[0], s[3], s[1]));
+    faces.push_back(addFace(s[1], s[3], s[2]));
+    faces.push_back(addFace(s[2], s[3], s[0]));
+    for (int f=0; f<4; ++f)
+    {
+      for (int k=0; k<3; ++k)
+      {
+        int a = _faces[f]._v[k];
+        int b = _faces[f]._v[(k+1)%3];
+        for (int g=0; g<4; ++g)
+        {
+          for (int m=0; m<3; ++m)
+          {
+            if (_faces[g]._v[m] == b && _faces[g]._v[(m+1)%3] == a)
+              _faces[f]._adj[k] = g;
+          }
+        }
+      }
+    }
+
+    for (int i=0; i<int(n); ++i)
+    {
+      if (i != s[0] && i != s[1] && i != s[2] && i != s[3])
+        assignPoint(i, faces);
+    }
+
+    for (unsigned int f=0; f<_faces.size(); ++f)
+    {
+      if (_faces[f]._alive && !_faces[f]._outside.empty())
+      {
+        if (!addPoint(f))
+        {
+          _inside.assign(n, false);
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void ConvexHull::boundaryPoints(std::vector<int>& indices) const
+  {
+    indices.clear();
+    for (unsigned int i=0; i<_inside.size(); ++i)
+    {
+      if (!_inside[i])
+        indices.push_back(i);
+    }
+  }
+}
@@ -0,0 +1,68 @@
+/*! \file ConvexHull.h
+ *  \brief Declaration file of the Class ConvexHull
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_CONVEX_HULL_H
+#define SCD_CONVEX_HULL_H
+
+#include <vector>
+
+#include "vector3.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+
+  /*! \class ConvexHull
+   *	\brief %Class ConvexHull
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Incremental (quickhull) convex hull of a 3d points cloud. It is only used to
+   * classify the points : those lying strictly inside the hull can't be vertices
+   * of the STP-BV and are discarded before the sphere-torus construction.
+   */
+  class ConvexHull
+  {
+  private:
+    struct Face
+    {
+      int					_v[3];			//counterclockwise seen from outside
+      int					_adj[3];		//face on the other side of [_v[k],_v[(k+1)%3]]
+      vector3d			_normal;
+      double				_offset;
+      bool				_alive;
+      std::vector<int>	_outside;		//points above the face, not yet on the hull
+    };
+
+  public:
+    ConvexHull(const std::vector<vector3d>& points);
+
+  public:
+    //compute the hull with a tolerance relative to the size of the cloud
+    //returns false if the cloud is degenerated (flat), then no point is discarded
+    bool	compute(double epsilon = 1e-10);
+    //indices, in increasing order, of the points that are not strictly inside the hull
+    void	boundaryPoints(std::vector<int>& indices) const;
+
+  private:
+    double	distance(int face, int point) const;
+    int		addFace(int a, int b, int c);
+    bool	initialSimplex(int s[4]);
+    void	assignPoint(int point, const std::vector<int>& faces);
+    bool	addPoint(int face);
+
+  private:
+    const std::vector<vector3d>&	_points;
+    std::vector<Face>				_faces;
+    std::vector<bool>				_inside;
+    std::vector<int>				_visited;
+    double							_epsilon;
+  };
+}
+
+#endif	//SCD_CONVEX_HULL_H
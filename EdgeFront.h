@@ -0,0 +1,209 @@
+/*! \file EdgeFront.h
+ *  \brief Declaration file of the Class EdgeFront
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_EDGE_FRONT_H
+#define SCD_EDGE_FRONT_H
+
+#include <vector>
+
+#include "EdgeHash.h"
+
+namespace SCD
+{
+  /*! \class EdgeFront
+   *	\brief %Class EdgeFront
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Addressable binary heap holding the edges of the front of travelCover.
+   * Each element is identified by a key, and ordered by priority then by insertion
+   * (as the multimap it replaces). Push, pop, erase and priority change are
+   * O(log n), finding an element from its key is O(1).
+   */
+  template <typename T>
+  class EdgeFront
+  {
+  private:
+    struct Entry
+    {
+      double			_priority;
+      unsigned long	_order;
+      edgeKey			_key;
+      T				_value;
+    };
+
+  public:
+    EdgeFront():_count(0)
+    {}
+
+    bool empty() const
+    {
+      return _heap.empty();
+    }
+
+    unsigned int size() const
+    {
+      return _heap.size();
+    }
+
+    /// Element with the smallest priority
+    const T& top() const
+    {
+      return _heap[0]._value;
+    }
+
+    double topPriority() const
+    {
+      return _heap[0]._priority;
+    }
+
+    /// The (at most) k elements with the smallest priorities, in order
+    void best(unsigned int k, std::vector<T>& values) const
+    {
+      values.clear();
+      //the next element is the best of the children of those already taken
+      std::vector<unsigned int> open;
+      if (!_heap.empty())
+        open.push_back(0);
+      while (!open.empty() && values.size() < k)
+      {
+        unsigned int b = 0;
+        for (unsigned int i=1; i<open.size(); ++i)
+        {
+          if (before(_heap[open[i]], _heap[open[b]]))
+            b = i;
+        }
+        unsigned int i = open[b];
+        open[b] = open.back();
+        open.pop_back();
+        values.push_back(_heap[i]._value);
+        if (2*i+1 < _heap.size())
+          open.push_back(2*i+1);
+        if (2*i+2 < _heap.size())
+          open.push_back(2*i+2);
+      }
+    }
+
+    /// Element identified by key, 0 if there is none
+    const T* find(edgeKey key) const
+    {
+      const unsigned int* i = _position.find(key);
+      return i?&(_heap[*i]._value):0;
+    }
+
+    /// Returns false (and does nothing) if key is already in the front
+    bool push(edgeKey key, double priority, const T& value)
+    {
+      if (!_position.insert(key, _heap.size()))
+        return false;
+      Entry e;
+      e._priority = priority;
+      e._order = _count++;
+      e._key = key;
+      e._value = value;
+      _heap.push_back(e);
+      siftUp(_heap.size()-1);
+      return true;
+    }
+
+    void pop()
+    {
+      remove(0);
+    }
+
+    bool erase(edgeKey key)
+    {
+      const unsigned int* i = _position.find(key);
+      if (!i)
+        return false;
+      remove(*i);
+      return true;
+    }
+
+    /// Changes the priority of an element, it then goes after the elements of same priority
+    bool update(edgeKey key, double priority)
+    {
+      const unsigned int* position = _position.find(key);
+      if (!position)
+        return false;
+      unsigned int i = *position;
+      _heap[i]._priority = priority;
+      _heap[i]._order = _count++;
+      siftDown(siftUp(i));
+      return true;
+    }
+
+    void clear()
+    {
+      _heap.clear();
+      _position.clear();
+    }
+
+  private:
+    bool before(const Entry& a, const Entry& b) const
+    {
+      return (a._priority < b._priority) || (a._priority == b._priority && a._order < b._order);
+    }
+
+    void place(unsigned int i, const Entry& e)
+    {
+      _heap[i] = e;
+      _position[e._key] = i;
+    }
+
+    unsigned int siftUp(unsigned int i)
+    {
+      Entry e = _heap[i];
+      while (i > 0 && before(e, _heap[(i-1)/2]))
+      {
+        place(i, _heap[(i-1)/2]);
+        i = (i-1)/2;
+      }
+      place(i, e);
+      return i;
+    }
+
+    unsigned int siftDown(unsigned int i)
+    {
+      Entry e = _heap[i];
+      unsigned int n = _heap.size();
+      while (2*i+1 < n)
+      {
+        unsigned int c = 2*i+1;
+        if (c+1 < n && before(_heap[c+1], _heap[c]))
+          ++c;
+        if (!before(_heap[c], e))
+          break;
+        place(i, _heap[c]);
+        i = c;
+      }
+      place(i, e);
+      return i;
+    }
+
+    void remove(unsigned int i)
+    {
+      _position.erase(_heap[i]._key);
+      if (i+1 < _heap.size())
+      {
+        _heap[i] = _heap.back();
+        _heap.pop_back();
+        siftDown(siftUp(i));
+      }
+      else
+        _heap.pop_back();
+    }
+
+  private:
+    std::vector<Entry>			_heap;
+    EdgeMap<unsigned int>		_position;
+    unsigned long				_count;
+  };
+}
+
+#endif	//SCD_EDGE_FRONT_H
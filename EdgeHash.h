@@ -0,0 +1,249 @@
+/*! \file EdgeHash.h
+ *  \brief Declaration file of the Classes EdgeMap and EdgeSet
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_EDGE_HASH_H
+#define SCD_EDGE_HASH_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace SCD
+{
+  /// Identifier of an edge : both indices packed on 64 bits
+  typedef boost::uint64_t edgeKey;
+
+  /// Key of the non-oriented edge [a,b]
+  inline edgeKey undirectedKey(int a, int b)
+  {
+    return (a<b)?((edgeKey(a)<<32)|edgeKey(b)):((edgeKey(b)<<32)|edgeKey(a));
+  }
+
+  /// Key of the oriented edge [a,b]
+  inline edgeKey directedKey(int a, int b)
+  {
+    return (edgeKey(a)<<32)|edgeKey(b);
+  }
+
+  /*! \class EdgeMap
+   *	\brief %Class EdgeMap
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning Insertions and erasures invalidate the pointers and references to the values
+   *
+   * Open addressing (linear probing) hash map whose keys are edges
+   */
+  template <typename T>
+  class EdgeMap
+  {
+  public:
+    EdgeMap():_size(0)
+    {
+      rehash(16);
+    }
+
+    unsigned int size() const
+    {
+      return _size;
+    }
+
+    bool empty() const
+    {
+      return _size == 0;
+    }
+
+    void clear()
+    {
+      _size = 0;
+      rehash(16);
+    }
+
+    void reserve(unsigned int n)
+    {
+      if (2*n > _keys.size())
+        rehash(2*n);
+    }
+
+    /// Value of key, 0 if there is none
+    T* find(edgeKey key)
+    {
+      unsigned int i = slot(key);
+      return (_keys[i] == key)?&_values[i]:0;
+    }
+
+    const T* find(edgeKey key) const
+    {
+      unsigned int i = slot(key);
+      return (_keys[i] == key)?&_values[i]:0;
+    }
+
+    bool contains(edgeKey key) const
+    {
+      return _keys[slot(key)] == key;
+    }
+
+    /// Returns false (and does nothing) if key is already in the map
+    bool insert(edgeKey key, const T& value)
+    {
+      unsigned int i = slot(key);
+      if (_keys[i] == key)
+        return false;
+      add(i, key, value);
+      return true;
+    }
+
+    /// Value of key, default-constructed if key was not in the map
+    T& operator[](edgeKey key)
+    {
+      unsigned int i = slot(key);
+      if (_keys[i] != key)
+        i = add(i, key, T());
+      return _values[i];
+    }
+
+    bool erase(edgeKey key)
+    {
+      unsigned int i = slot(key);
+      if (_keys[i] != key)
+        return false;
+
+      //backward shift of the following elements of the cluster
+      unsigned int mask = _keys.size()-1;
+      unsigned int j = i;
+      while (true)
+      {
+        j = (j+1)&mask;
+        if (_keys[j] == emptyKey())
+          break;
+        unsigned int h = hash(_keys[j])&mask;
+        //move j to i if its home slot is not in ]i,j]
+        if ((j > i && (h <= i || h > j)) || (j < i && (h <= i && h > j)))
+        {
+          _keys[i] = _keys[j];
+          _values[i] = _values[j];
+          i = j;
+        }
+      }
+      _keys[i] = emptyKey();
+      _values[i] = T();
+      --_size;
+      return true;
+    }
+
+  private:
+    static edgeKey emptyKey()
+    {
+      return ~edgeKey(0);
+    }
+
+    static unsigned int hash(edgeKey key)
+    {
+      //finalizer of MurmurHash3
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33;
+      key *= 0xc4ceb9fe1a85ec53ULL;
+      key ^= key >> 33;
+      return (unsigned int)key;
+    }
+
+    /// Slot of key, or empty slot where it would be inserted
+    unsigned int slot(edgeKey key) const
+    {
+      unsigned int mask = _keys.size()-1;
+      unsigned int i = hash(key)&mask;
+      while (_keys[i] != key && _keys[i] != emptyKey())
+        i = (i+1)&mask;
+      return i;
+    }
+
+    unsigned int add(unsigned int i, edgeKey key, const T& value)
+    {
+      if (2*(_size+1) > _keys.size())
+      {
+        rehash(2*_keys.size());
+        i = slot(key);
+      }
+      _keys[i] = key;
+      _values[i] = value;
+      ++_size;
+      return i;
+    }
+
+    void rehash(unsigned int n)
+    {
+      unsigned int capacity = 16;
+      while (capacity < n)
+        capacity *= 2;
+      std::vector<edgeKey> keys(capacity, emptyKey());
+      std::vector<T> values(capacity);
+      keys.swap(_keys);
+      values.swap(_values);
+      for (unsigned int i=0; i<keys.size(); ++i)
+      {
+        if (keys[i] != emptyKey())
+        {
+          unsigned int j = slot(keys[i]);
+          _keys[j] = keys[i];
+          _values[j] = values[i];
+        }
+      }
+    }
+
+  private:
+    std::vector<edgeKey>	_keys;
+    std::vector<T>			_values;
+    unsigned int			_size;
+  };
+
+  /*! \class EdgeSet
+   *	\brief %Class EdgeSet
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Open addressing hash set of edges
+   */
+  class EdgeSet
+  {
+  public:
+    unsigned int size() const
+    {
+      return _map.size();
+    }
+
+    void clear()
+    {
+      _map.clear();
+    }
+
+    void reserve(unsigned int n)
+    {
+      _map.reserve(n);
+    }
+
+    bool contains(edgeKey key) const
+    {
+      return _map.contains(key);
+    }
+
+    /// Returns false if key was already in the set
+    bool insert(edgeKey key)
+    {
+      return _map.insert(key, true);
+    }
+
+    bool erase(edgeKey key)
+    {
+      return _map.erase(key);
+    }
+
+  private:
+    EdgeMap<bool> _map;
+  };
+}
+
+#endif	//SCD_EDGE_HASH_H
@@ -0,0 +1,216 @@
+#include "FarthestPointTree.h"
+#include <algorithm>
+
+namespace SCD
+{
+  namespace
+  {
+    const int leafSize = 32;
+
+    struct CompareAxis
+    {
+      const std::vector<vector3d>* _points;
+      int _axis;
+      bool operator()(int a, int b) const
+      {
+        return (*_points)[a][_axis] < (*_points)[b][_axis];
+      }
+    };
+  }
+
+  FarthestPointTree::FarthestPointTree():
+    _kernels(&sphereKernels())
+  {
+  }
+
+  void FarthestPointTree::build(const std::vector<vector3d>& points)
+  {
+    _index.resize(points.size());
+    for (unsigned int i=0; i<points.size(); ++i)
+      _index[i] = i;
+    _points = points;
+    _nodes.clear();
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    if (points.empty())
+      return;
+    _nodes.reserve(4*points.size()/leafSize + 1);
+    _nodes.resize(1);
+    buildNode(0, 0, points.size());
+
+    //store the points in the order of the leaves
+    _x.resize(_index.size());
+    _y.resize(_index.size());
+    _z.resize(_index.size());
+    for (unsigned int i=0; i<_index.size(); ++i)
+    {
+      _x[i] = points[_index[i]].x;
+      _y[i] = points[_index[i]].y;
+      _z[i] = points[_index[i]].z;
+    }
+    std::vector<vector3d>().swap(_points);
+  }
+
+  void FarthestPointTree::buildNode(int id, int begin, int end)
+  {
+    Node n;
+    n._begin = begin;
+    n._end = end;
+    n._child = -1;
+    n._min = n._max = _points[_index[begin]];
+    for (int i=begin+1; i<end; ++i)
+    {
+      const vector3d& p = _points[_index[i]];
+      for (int k=0; k<3; ++k)
+      {
+        n._min[k] = std::min(n._min[k], p[k]);
+        n._max[k] = std::max(n._max[k], p[k]);
+      }
+    }
+
+    if (end-begin > leafSize)
+    {
+      //split along the largest dimension of the box
+      vector3d size = n._max-n._min;
+      CompareAxis cmp;
+      cmp._points = &_points;
+      cmp._axis = (size.x>size.y)?((size.x>size.z)?0:2):((size.y>size.z)?1:2);
+      int mid = (begin+end)/2;
+      std::nth_element(_index.begin()+begin, _index.begin()+mid, _index.begin()+end, cmp);
+
+      //children are stored next to each other
+      n._child = _nodes.size();
+      _nodes[id] = n;
+      _nodes.resize(_nodes.size()+2);
+      buildNode(n._child, begin, mid);
+      buildNode(n._child+1, mid, end);
+    }
+    else
+    {
+      //the first farthest point of a leaf is then the one of smallest index
+      std::sort(_index.begin()+begin, _index.begin()+end);
+      _nodes[id] = n;
+    }
+  }
+
+  double FarthestPointTree::maxDist2(const Node& node, const vector3d& center) const
+  {
+    //same operations as (center-p).normsquared(), with the farthest coordinates of the box
+    double x = std::max(fabs(center.x-node._min.x), fabs(center.x-node._max.x));
+    double y = std::max(fabs(center.y-node._min.y), fabs(center.y-node._max.y));
+    double z = std::max(fabs(center.z-node._min.z), fabs(center.z-node._max.z));
+    return x*x+y*y+z*z;
+  }
+
+  int FarthestPointTree::farthest(const vector3d& center, double& dist2) const
+  {
+    int best = -1;
+    dist2 = -1;
+    if (_nodes.empty())
+      return best;
+
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+      const Node& n = _nodes[stack[--top]];
+      if (maxDist2(n, center) < dist2)
+        continue;
+      if (n._child < 0)
+      {
+        int arg;
+        double d = _kernels->_maxDist2(&_x[n._begin], &_y[n._begin], &_z[n._begin], n._end-n._begin, center, arg);
+        if (d > dist2 || (d == dist2 && _index[n._begin+arg] < best))
+        {
+          dist2 = d;
+          best = _index[n._begin+arg];
+        }
+      }
+      else
+      {
+        //the most promising child is explored first
+        double d1 = maxDist2(_nodes[n._child], center);
+        double d2 = maxDist2(_nodes[n._child+1], center);
+        if (d1 > d2)
+        {
+          stack[top++] = n._child+1;
+          stack[top++] = n._child;
+        }
+        else
+        {
+          stack[top++] = n._child;
+          stack[top++] = n._child+1;
+        }
+      }
+    }
+    return best;
+  }
+
+  int FarthestPointTree::findBeyond(const vector3d& center, double dist2) const
+  {
+    if (_nodes.empty())
+      return -1;
+
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+      const Node& n = _nodes[stack[--top]];
+      if (maxDist2(n, center) <= dist2)
+        continue;
+      if (n._child < 0)
+      {
+        int i = _kernels->_firstBeyond(&_x[n._begin], &_y[n._begin], &_z[n._begin], n._end-n._begin, center, dist2);
+        if (i >= 0)
+          return _index[n._begin+i];
+      }
+      else
+      {
+        stack[top++] = n._child+1;
+        stack[top++] = n._child;
+      }
+    }
+    return -1;
+  }
+
+  bool FarthestPointTree::allWithin(const vector3d& center, double dist2) const
+  {
+    return findBeyond(center, dist2) < 0;
+  }
+
+  void FarthestPointTree::beyond(const vector3d& center, double dist2, std::vector<int>& indices) const
+  {
+    indices.clear();
+    if (_nodes.empty())
+      return;
+
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+      const Node& n = _nodes[stack[--top]];
+      if (maxDist2(n, center) <= dist2)
+        continue;
+      if (n._child < 0)
+      {
+        for (int b=n._begin; b<n._end; )
+        {
+          int i = _kernels->_firstBeyond(&_x[b], &_y[b], &_z[b], n._end-b, center, dist2);
+          if (i < 0)
+            break;
+          indices.push_back(_index[b+i]);
+          b += i+1;
+        }
+      }
+      else
+      {
+        stack[top++] = n._child+1;
+        stack[top++] = n._child;
+      }
+    }
+  }
+}
@@ -0,0 +1,75 @@
+/*! \file FarthestPointTree.h
+ *  \brief Declaration file of the Class FarthestPointTree
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_FARTHEST_POINT_TREE_H
+#define SCD_FARTHEST_POINT_TREE_H
+
+#include <vector>
+
+#include "vector3.h"
+#include "SphereKernels.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+
+  /*! \class FarthestPointTree
+   *	\brief %Class FarthestPointTree
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Kd-tree over a 3d points cloud answering farthest point queries.
+   * Each node keeps the bounding box of its points, the distance to the farthest
+   * corner of the box bounds the distance to all of them, so the nodes that can't
+   * change the answer are skipped. The bounds are computed with the same operations
+   * as the distances to the points, the answers are thus exactly those of a linear scan.
+ * The points are stored by component, leaf after leaf, and the leaves are scanned
+ * with the SIMD kernels of the processor.
+   */
+  class FarthestPointTree
+  {
+  private:
+    struct Node
+    {
+      vector3d	_min;
+      vector3d	_max;
+      int			_begin;
+      int			_end;
+      int			_child;			//children are _child and _child+1, -1 for a leaf
+    };
+
+  public:
+    FarthestPointTree();
+
+  public:
+    void	build(const std::vector<vector3d>& points);
+    //index of the farthest point from center (the smallest one in case of equality)
+    //and its squared distance
+    int		farthest(const vector3d& center, double& dist2) const;
+    //index of a point whose squared distance to center is greater than dist2, -1 if there is none
+    int		findBeyond(const vector3d& center, double dist2) const;
+    bool	allWithin(const vector3d& center, double dist2) const;
+    //indices of all the points whose squared distance to center is greater than dist2
+    void	beyond(const vector3d& center, double dist2, std::vector<int>& indices) const;
+
+  private:
+    void	buildNode(int id, int begin, int end);
+    double	maxDist2(const Node& node, const vector3d& center) const;
+
+  private:
+    std::vector<vector3d>	_points;		//copy of the cloud during the build
+    alignedDoubles			_x;				//coordinates of the points sorted by node
+    alignedDoubles			_y;
+    alignedDoubles			_z;
+    std::vector<int>		_index;			//original index of the sorted points, increasing in each leaf
+    std::vector<Node>		_nodes;
+    const SphereKernels*	_kernels;
+  };
+}
+
+#endif	//SCD_FARTHEST_POINT_TREE_H
@@ -1,12 +1,261 @@
 #include "SmoothHullGeneratorVVR.h"
+#include "CloudFile.h"
+#include "STPBVCache.h"
+#include "SphereKernels.h"
 #include <iostream>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <algorithm>
+#include <ctime>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
 
 using namespace std;
 namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+//output file of the pair (r,R) among several : output_r_R.ext
+string radiiOutput(const string& output, double r, double R)
+{
+  ostringstream suffix;
+  suffix << "_" << r << "_" << R;
+  size_t dot = output.find_last_of('.');
+  if (dot == string::npos || (output.find_last_of("/\\") != string::npos && dot < output.find_last_of("/\\")))
+    return output + suffix.str();
+  return output.substr(0, dot) + suffix.str() + output.substr(dot);
+}
+
+//options of the computation, shared by the single file and the batch modes
+void configure(SCD::SmoothHullGeneratorVVR& sg, const po::variables_map& vm)
+{
+  sg.setHullFilter(vm["hull-filter"].as<bool>());
+  sg.setThreads(vm["threads"].as<int>());
+  sg.setSpeculation(vm["speculate"].as<int>());
+  sg.setMixedPrecision(vm["mixed"].as<bool>());
+  sg.setWelding(vm["weld"].as<double>());
+  sg.setDecimation(vm["decimate-tol"].as<double>(), vm["decimate-count"].as<unsigned int>());
+  //the cache is opt-in, and the insertion updates the STP-BV computed
+  bool cache = vm.count("cache") || !vm["cache-dir"].defaulted();
+  if (cache && !vm.count("no-cache") && !vm.count("add"))
+    sg.setCache(vm["cache-dir"].as<string>(), boost::uint64_t(vm["cache-size"].as<double>()*1024*1024));
+}
+
+double wallTime()
+{
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return double(time(0));
+#endif
+}
+
+struct batchEntry
+{
+  string			_input;
+  double			_r;
+  double			_R;
+  boost::uintmax_t	_size;
+  string			_output;
+  string			_status;
+  string			_error;			//the last message of the computation, if it failed
+  vector<string>	_warnings;		//its messages with a warning or an error
+  unsigned int		_faces;
+  double			_time;
+};
+
+bool largerEntry(const batchEntry* a, const batchEntry* b)
+{
+  return a->_size > b->_size;
+}
+
+bool inputOrder(const batchEntry& a, const batchEntry& b)
+{
+  return a._input < b._input;
+}
+
+//keep the messages of a computation needed in the batch summary
+void batchMessages(batchEntry& e, const string& log)
+{
+  istringstream is(log);
+  for (string line; getline(is, line); )
+  {
+    if (line.empty())
+      continue;
+    if (line.find("WARNING") != string::npos || line.find("ERROR") != string::npos)
+      e._warnings.push_back(line);
+    //the steps are written as "step..... result", the error is the result of the last one
+    size_t step = line.rfind("..... ");
+    if (e._status != "ok")
+      e._error = (step == string::npos)?line:line.substr(step + 6);
+  }
+  //a computation which fails goes on to its end, its error is the one reported on the way
+  if (e._status == "failed" && !e._warnings.empty())
+    e._error = e._warnings.back();
+}
+
+//the inputs of the batch : the clouds and meshes of a directory, or the lines "input [r R]" of a list
+bool batchEntries(const string& source, double r, double R, vector<batchEntry>& entries)
+{
+  batchEntry e;
+  e._r = r;
+  e._R = R;
+  e._faces = 0;
+  e._time = 0.;
+  boost::system::error_code ec;
+  if (fs::is_directory(source, ec))
+  {
+    const char* extensions[] = {".qc", ".cloud", ".wrl", ".obj", ".ply", ".stl"};
+    for (fs::directory_iterator it(source, ec), end; it != end && !ec; it.increment(ec))
+    {
+      string extension = it->path().extension().string();
+      transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+      if (fs::is_regular_file(it->status()) && find(extensions, extensions+6, extension) != extensions+6)
+      {
+        e._input = it->path().string();
+        entries.push_back(e);
+      }
+    }
+    if (ec)
+    {
+      cout << "unable to read the directory " << source << ": " << ec.message() << endl;
+      return false;
+    }
+    sort(entries.begin(), entries.end(), inputOrder);
+    return true;
+  }
+
+  ifstream list(source.c_str());
+  if (!list.is_open())
+  {
+    cout << "unable to open the directory or the list " << source << endl;
+    return false;
+  }
+  string line;
+  for (int l=1; getline(list, line); ++l)
+  {
+    istringstream is(line.substr(0, line.find('#')));
+    vector<string> tokens;
+    for (string t; is >> t; )
+      tokens.push_back(t);
+    if (tokens.empty())
+      continue;
+    //the relative inputs are in the directory of the list
+    fs::path input(tokens[0]);
+    if (input.is_relative())
+      input = fs::path(source).parent_path() / input;
+    e._input = input.string();
+    e._r = r;
+    e._R = R;
+    istringstream radii((tokens.size() == 3)?tokens[1] + " " + tokens[2]:"");
+    if (tokens.size() != 1 && !(radii >> e._r >> e._R))
+    {
+      cout << source << ":" << l << ": expected \"input [r R]\"" << endl;
+      return false;
+    }
+    entries.push_back(e);
+  }
+  return true;
+}
+
+//compute the STP-BV of the batch entries in parallel, the largest inputs first, and print a summary
+int batch(const string& source, const po::variables_map& vm, double r, double R, SCD::STPBVFormat format)
+{
+  //the only file given is the output directory
+  if (vm.count("input-file") && vm.count("output-file"))
+  {
+    cout << "the batch mode takes its inputs from " << source << ", only the output directory can be given" << endl;
+    return 1;
+  }
+  if (vm.count("radii") || vm.count("add") || vm["poly"].as<bool>())
+  {
+    cout << "the options --radii, --add and --poly are not available in the batch mode" << endl;
+    return 1;
+  }
+  vector<batchEntry> entries;
+  if (!batchEntries(source, r, R, entries))
+    return 1;
+  string outputDir = vm.count("input-file")?vm["input-file"].as<string>():"";
+  if (vm.count("output-file"))
+    outputDir = vm["output-file"].as<string>();
+
+  vector<batchEntry*> order;
+  for (unsigned int i=0; i<entries.size(); ++i)
+  {
+    batchEntry& e = entries[i];
+    boost::system::error_code ec;
+    e._size = fs::file_size(e._input, ec);
+    if (ec)
+      e._size = 0;
+    fs::path output = fs::path(outputDir.empty()?fs::path(e._input).parent_path():fs::path(outputDir));
+    output /= fs::path(e._input).stem().string() + ((format == SCD::STPBV_BINARY)?".stpbv":".txt");
+    e._output = output.string();
+    order.push_back(&e);
+  }
+  stable_sort(order.begin(), order.end(), largerEntry);
+
+  int jobs = vm["jobs"].as<int>();
+#ifdef _OPENMP
+  jobs = (jobs > 0)?jobs:omp_get_num_procs();
+#else
+  jobs = 1;
+#endif
+  cout << "Batch of " << entries.size() << " files on " << jobs << " threads" << endl;
+
+  //the messages of each computation are kept on its own stream, only the progress and the warnings are printed
+  double start = wallTime();
+  int n = int(order.size());
+  int done = 0;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(jobs)
+  for (int k=0; k<n; ++k)
+  {
+    batchEntry& e = *order[k];
+    double t = wallTime();
+    ostringstream log;
+    SCD::SmoothHullGeneratorVVR sg(e._r, e._R);
+    sg.setOutput(log);
+    configure(sg, vm);
+    SCD::STPBV stpbv;
+    if (!sg.loadGeometry(e._input))
+      e._status = "unreadable";
+    else
+    {
+      sg.computeVVR_Prime(stpbv);
+      e._faces = stpbv._bigSpheres.size();
+      if (e._faces == 0)
+        e._status = "failed";
+      else if (!SCD::writeSTPBV(stpbv, e._output, format, log))
+        e._status = "unwritable";
+      else
+        e._status = "ok";
+    }
+    e._time = wallTime() - t;
+    batchMessages(e, log.str());
+#pragma omp critical
+    {
+      ++done;
+      cout << "[" << done << "/" << n << "] " << e._status << " " << e._input << endl;
+      for (unsigned int i=0; i<e._warnings.size(); ++i)
+        cout << "    " << e._warnings[i] << endl;
+    }
+  }
+
+  int created = 0;
+  cout << endl << "status\tfaces\ttime (s)\tr\tR\tinput -> output\terror" << endl;
+  for (unsigned int i=0; i<entries.size(); ++i)
+  {
+    const batchEntry& e = entries[i];
+    cout << e._status << "\t" << e._faces << "\t" << e._time << "\t" << e._r << "\t" << e._R << "\t"
+         << e._input << " -> " << e._output << "\t" << e._error << endl;
+    created += (e._status == "ok");
+  }
+  cout << created << "/" << entries.size() << " STP-BV created in " << wallTime() - start << " s" << endl;
+  return (created == int(entries.size()))?0:1;
+}
 
 int main(int argc, char **argv)
 {
@@ -17,9 +266,27 @@ int main(int argc, char **argv)
   ("help,h", "produce help message")
   ("r,r", po::value<double>(&r)->default_value(.2), "small sphere radius")
   ("R,R", po::value<double>(&R)->default_value(300.), "big sphere radius")
-  ("input-file", po::value<string>(), "input file")
+  ("input-file", po::value<string>(), "input file : a cloud (.qc, .cloud) or a mesh (VRML, OBJ, PLY, STL) whose vertices are taken")
   ("output-file", po::value<string>(), "output file")
-  ("poly", po::value<bool>()->default_value(false), "generate the polyhedron of the STP-BV");
+  ("poly", po::value<bool>()->default_value(false), "generate the polyhedron of the STP-BV")
+  ("hull-filter", po::value<bool>()->default_value(true), "discard the points strictly inside the convex hull before computing the STP-BV (the same, its patches may be in another order)")
+  ("threads", po::value<int>()->default_value(1), "number of threads evaluating the candidate vertices (0 for all the cores)")
+  ("speculate", po::value<int>()->default_value(0), "number of front edges whose successors are pivoted ahead on the threads (0 to disable)")
+  ("mixed", po::value<bool>()->default_value(false), "filter the candidate vertices in single precision, with the same result")
+  ("weld", po::value<double>()->default_value(-1.), "merge the input points closer than this distance (0 for the exact duplicates only, negative to disable)")
+  ("decimate-tol", po::value<double>()->default_value(0.), "reduce the input cloud with an outward error below this distance (0 to disable)")
+  ("decimate-count", po::value<unsigned int>()->default_value(0), "reduce the input cloud to at most this number of points (0 to disable)")
+  ("add", po::value<string>(), "points file added to the cloud once its STP-BV is computed, updating it locally")
+  ("radii", po::value<vector<string> >()->multitoken(), "several pairs r,R (replacing -r and -R) : one output file per pair, output_r_R.ext, the STP-BV being computed once per value of R-r")
+  ("format", po::value<string>()->default_value("txt"), "format of the output file : txt (read by sch-core) or bin (little-endian, usable in place once mapped in memory)")
+  ("check-kernels", "compare the SIMD kernels supported by the processor with the scalar ones on random cases, and exit")
+  ("convert", "the input file is an STP-BV, in any format, rewritten in the output one")
+  ("batch", po::value<string>(), "compute the STP-BV of the clouds and meshes of a directory, or of the files of a list with a line \"input [r R]\" per file (relative to the list), in the output directory (default: the one of each input) named after the inputs")
+  ("jobs", po::value<int>()->default_value(0), "number of files computed in parallel in the batch mode (0 for all the cores)")
+  ("cache", "reuse the STP-BV computed for the same points, radii and hull filter from the cache directory, and store the new ones in it (off by default)")
+  ("no-cache", "compute the STP-BV without the cache, even with --cache or --cache-dir")
+  ("cache-dir", po::value<string>()->default_value(SCD::STPBVCache::defaultDirectory()), "directory of the cache, giving it enables --cache")
+  ("cache-size", po::value<double>()->default_value(1024.), "size limit of the cache in MB, the least recently used STP-BV being removed beyond");
 
   po::positional_options_description pos;
   pos.add("input-file", 1);
@@ -35,7 +302,53 @@ int main(int argc, char **argv)
     return 1;
   }
 
-  cout << "\n STP-BV parameters: r = " << r << ", R = " << R << std::endl << std::endl;
+  if (vm.count("check-kernels"))
+  {
+    const int cases = 2000;
+    int mismatches = 0;
+    const SCD::KernelSet sets[] = {SCD::scalarKernels, SCD::avx2Kernels, SCD::avx512Kernels};
+    for (int s=1; s<3; ++s)
+    {
+      const SCD::SphereKernels& kernels = SCD::sphereKernels(sets[s]);
+      if (&kernels == &SCD::sphereKernels(sets[s-1]))
+        continue;
+      int m = SCD::compareSphereKernels(kernels, cases, cout);
+      cout << "kernels " << kernels._name << ": " << m << "/" << cases << " cases differ from the scalar ones" << endl;
+      mismatches += m;
+    }
+    return (mismatches == 0)?0:1;
+  }
+
+  string format = vm["format"].as<string>();
+  if (format != "txt" && format != "bin")
+  {
+    cout << "wrong format " << format << ", expected txt or bin" << endl;
+    return 1;
+  }
+  SCD::STPBVFormat outputFormat = (format == "bin")?SCD::STPBV_BINARY:SCD::STPBV_TEXT;
+
+  if (vm.count("convert"))
+  {
+    if (!vm.count("input-file") || !vm.count("output-file"))
+    {
+      cout << "the conversion needs an input and an output file" << endl;
+      return 1;
+    }
+    SCD::STPBV stpbv;
+    string input = vm["input-file"].as<string>();
+    string output = vm["output-file"].as<string>();
+    if (!SCD::readSTPBV(stpbv, input) || !SCD::writeSTPBV(stpbv, output, outputFormat))
+      return 1;
+    cout << "STP-BV " << input << " converted, output file " << output << endl;
+    return 0;
+  }
+
+  if (vm.count("batch"))
+    return batch(vm["batch"].as<string>(), vm, r, R, outputFormat);
+
+  //with --radii, the parameters are printed for each pair by the generator
+  if (!vm.count("radii"))
+    cout << "\n STP-BV parameters: r = " << r << ", R = " << R << std::endl << std::endl;
 
   if (vm.count("input-file") && vm.count("output-file"))
   {
@@ -52,11 +365,55 @@ int main(int argc, char **argv)
 
       testfile.close();
 
-      sg.loadGeometry(input);
+      configure(sg, vm);
+      sg.setOutputFormat(outputFormat);
+      if (!sg.loadGeometry(input))
+      {
+        cout << "Failed to read " << input << endl;
+        return 1;
+      }
       if(vm["poly"].as<bool>())
         sg.computeVVR_WithPolyhedron(output);
+      else if (vm.count("radii"))
+      {
+        vector<string> pairs = vm["radii"].as<vector<string> >();
+        vector<pair<double, double> > radii;
+        vector<string> outputs;
+        for (unsigned int i=0; i<pairs.size(); ++i)
+        {
+          double ri, Ri;
+          char comma;
+          istringstream is(pairs[i]);
+          if (!(is >> ri >> comma >> Ri) || comma != ',')
+          {
+            cout << "wrong pair of radii " << pairs[i] << ", expected r,R" << endl;
+            return 1;
+          }
+          radii.push_back(make_pair(ri, Ri));
+          outputs.push_back(radiiOutput(output, ri, Ri));
+        }
+        sg.computeVVR_Prime(radii, outputs);
+        output = outputs[0];
+        for (unsigned int i=1; i<outputs.size(); ++i)
+          output += ", " + outputs[i];
+      }
       else
-        sg.computeVVR_Prime(output);
+      {
+        if (vm.count("add"))
+        {
+          //only the updated STP-BV is written
+          SCD::STPBV stpbv;
+          sg.computeVVR_Prime(stpbv);
+          if (!sg.insertGeometry(vm["add"].as<string>()))
+          {
+            cout << "Failed to read " << vm["add"].as<string>() << endl;
+            return 1;
+          }
+          sg.outputVVR_Prime(output);
+        }
+        else
+          sg.computeVVR_Prime(output);
+      }
 
       cout << "STP-BV Created, output file "<< output << endl;
       cout << "Successfully finished" << endl;
@@ -0,0 +1,79 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace SCD
+{
+  MappedFile::MappedFile(const std::string& filename):
+    _data(0),
+    _size(0),
+    _open(false),
+    _mapped(false)
+  {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+    {
+      _size = std::size_t(st.st_size);
+      _open = true;
+      if (_size > 0)
+      {
+        void* p = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+        {
+          _data = static_cast<const char*>(p);
+          _mapped = true;
+        }
+        else
+          _open = false;
+      }
+    }
+    close(fd);
+#else
+    std::ifstream is(filename.c_str(), std::ios::binary);
+    if (!is.is_open())
+      return;
+    is.seekg(0, std::ios::end);
+    _buffer.resize(std::size_t(is.tellg()));
+    is.seekg(0, std::ios::beg);
+    if (!_buffer.empty())
+      is.read(&_buffer[0], std::streamsize(_buffer.size()));
+    _open = bool(is);
+    _size = _buffer.size();
+    _data = _buffer.empty()?0:&_buffer[0];
+#endif
+  }
+
+  MappedFile::~MappedFile()
+  {
+#ifndef _WIN32
+    if (_mapped)
+      munmap(const_cast<char*>(_data), _size);
+#endif
+  }
+
+  bool MappedFile::isOpen() const
+  {
+    return _open;
+  }
+
+  const char* MappedFile::data() const
+  {
+    return _data;
+  }
+
+  std::size_t MappedFile::size() const
+  {
+    return _size;
+  }
+}
@@ -0,0 +1,51 @@
+/*! \file MappedFile.h
+ *  \brief Declaration file of the Class MappedFile
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_MAPPED_FILE_H
+#define SCD_MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace SCD
+{
+  /*! \class MappedFile
+   *	\brief %Class MappedFile
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Read-only view of the whole content of a file. The file is mapped in memory where mmap exists,
+   * and read in a buffer otherwise
+   */
+  class MappedFile
+  {
+  public:
+    MappedFile(const std::string& filename);
+    ~MappedFile();
+
+  public:
+    bool		isOpen() const;
+    //content of the file, size() bytes (not null-terminated)
+    const char*	data() const;
+    std::size_t	size() const;
+
+  private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+  private:
+    const char*			_data;
+    std::size_t			_size;
+    bool				_open;
+    bool				_mapped;
+    std::vector<char>	_buffer;		//content read, if the file is not mapped
+  };
+}
+
+#endif	//SCD_MAPPED_FILE_H
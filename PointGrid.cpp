@@ -0,0 +1,72 @@
+#include "PointGrid.h"
+#include <algorithm>
+
+namespace SCD
+{
+  PointGrid::PointGrid(const vector3d& boxMin, const vector3d& boxMax, double cellSize):
+    _min(boxMin),
+    _cellSize(cellSize)
+  {
+    //margin of a cell on both sides for the shifted cells, and for the rounding of the divisions
+    const double maxCells = double((1<<21)-4);
+    for (int m=0; m<3; ++m)
+      _cellSize = std::max(_cellSize, (boxMax[m]-boxMin[m])/maxCells);
+    if (_cellSize == 0.)
+      _cellSize = 1.;
+  }
+
+  double PointGrid::cellSize() const
+  {
+    return _cellSize;
+  }
+
+  edgeKey PointGrid::cell(const vector3d& p, int dx, int dy, int dz) const
+  {
+    edgeKey cx = edgeKey(int((p.x-_min.x)/_cellSize)+1+dx);
+    edgeKey cy = edgeKey(int((p.y-_min.y)/_cellSize)+1+dy);
+    edgeKey cz = edgeKey(int((p.z-_min.z)/_cellSize)+1+dz);
+    return (cx<<42)|(cy<<21)|cz;
+  }
+
+  void PointGrid::insert(const vector3d& p, int index)
+  {
+    if (int(_next.size()) <= index)
+      _next.resize(index+1, -1);
+    edgeKey c = cell(p);
+    int* f = _first.find(c);
+    if (f)
+    {
+      _next[index] = *f;
+      *f = index;
+    }
+    else
+    {
+      _next[index] = -1;
+      _first.insert(c, index);
+    }
+  }
+
+  int PointGrid::first(edgeKey cell) const
+  {
+    const int* f = _first.find(cell);
+    return f?*f:-1;
+  }
+
+  int PointGrid::next(int index) const
+  {
+    return _next[index];
+  }
+
+  void boundingBox(const std::vector<vector3d>& points, vector3d& boxMin, vector3d& boxMax)
+  {
+    boxMin = boxMax = points[0];
+    for (unsigned int i=1; i<points.size(); ++i)
+    {
+      for (int m=0; m<3; ++m)
+      {
+        boxMin[m] = std::min(boxMin[m], points[i][m]);
+        boxMax[m] = std::max(boxMax[m], points[i][m]);
+      }
+    }
+  }
+}
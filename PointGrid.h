@@ -0,0 +1,58 @@
+/*! \file PointGrid.h
+ *  \brief Declaration file of the Class PointGrid
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_POINT_GRID_H
+#define SCD_POINT_GRID_H
+
+#include <vector>
+
+#include "vector3.h"
+#include "EdgeHash.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+
+  /*! \class PointGrid
+   *	\brief %Class PointGrid
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Uniform grid over a box, hashed on its non empty cells. Each cell holds the list of the
+   * indices inserted in it, the last inserted first. The cells are at least as large as asked,
+   * so the points closer than this size to a point are in the 3x3x3 cells around its own.
+   * The cell coordinates are packed on 21 bits each, which bounds the number of cells along
+   * an axis : the cells are enlarged if the box is too large for the size asked.
+   */
+  class PointGrid
+  {
+  public:
+    PointGrid(const vector3d& boxMin, const vector3d& boxMax, double cellSize);
+
+  public:
+    double	cellSize() const;
+    //cell of a point of the box, shifted by d (each component in [-1,1])
+    edgeKey	cell(const vector3d& p, int dx = 0, int dy = 0, int dz = 0) const;
+    void	insert(const vector3d& p, int index);
+    //first index of the cell, -1 if it is empty
+    int		first(edgeKey cell) const;
+    //index following index in its cell, -1 if it is the last one
+    int		next(int index) const;
+
+  private:
+    vector3d			_min;
+    double				_cellSize;
+    EdgeMap<int>		_first;
+    std::vector<int>	_next;
+  };
+
+  //bounding box of a cloud, which must not be empty
+  void boundingBox(const std::vector<vector3d>& points, vector3d& boxMin, vector3d& boxMax);
+}
+
+#endif	//SCD_POINT_GRID_H
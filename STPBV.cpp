@@ -0,0 +1,548 @@
+#include "STPBV.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#if defined(__cpp_lib_to_chars)
+#define SCD_TO_CHARS
+#endif
+#endif
+
+namespace SCD
+{
+  namespace
+  {
+    //the records of the binary format are written field by field : their sizes must be the ones of the structs
+    typedef char checkHeaderSize[sizeof(STPBVBinaryHeader) == 112 ? 1 : -1];
+    typedef char checkSphereSize[sizeof(STPBVBinarySphere) == 32 ? 1 : -1];
+    typedef char checkConeSize[sizeof(STPBVBinaryCone) == 40 ? 1 : -1];
+    typedef char checkPlaneSize[sizeof(STPBVBinaryPlane) == 32 ? 1 : -1];
+    typedef char checkBigSphereSize[sizeof(STPBVBinaryBigSphere) == 200 ? 1 : -1];
+    typedef char checkTorusSize[sizeof(STPBVBinaryTorus) == 216 ? 1 : -1];
+
+    const char binaryMagic[8] = {'S', 'T', 'P', 'B', 'V', 'B', 'I', 'N'};
+
+    //little-endian encoding, whatever the host
+    void putUInt64(std::vector<char>& buffer, boost::uint64_t v)
+    {
+      for (int k=0; k<8; ++k)
+        buffer.push_back(char((v >> (8*k)) & 0xff));
+    }
+
+    void putUInt32(std::vector<char>& buffer, boost::uint32_t v)
+    {
+      for (int k=0; k<4; ++k)
+        buffer.push_back(char((v >> (8*k)) & 0xff));
+    }
+
+    void putDouble(std::vector<char>& buffer, double d)
+    {
+      boost::uint64_t v;
+      std::memcpy(&v, &d, sizeof(v));
+      putUInt64(buffer, v);
+    }
+
+    void putVector(std::vector<char>& buffer, const vector3d& v)
+    {
+      putDouble(buffer, v.x);
+      putDouble(buffer, v.y);
+      putDouble(buffer, v.z);
+    }
+
+    void putSphere(std::vector<char>& buffer, const VVRsphere& sphere)
+    {
+      putDouble(buffer, sphere._radius);
+      putVector(buffer, sphere._center);
+    }
+
+    void putCone(std::vector<char>& buffer, const VVRcone& cone)
+    {
+      putDouble(buffer, cone.second._cosangle);
+      putVector(buffer, cone.second._axis);
+      putUInt32(buffer, boost::uint32_t(cone.first));
+      putUInt32(buffer, 0);
+    }
+
+    void putPlane(std::vector<char>& buffer, const VVRplane& plane)
+    {
+      putVector(buffer, plane.second);
+      putUInt32(buffer, boost::uint32_t(plane.first));
+      putUInt32(buffer, 0);
+    }
+
+    boost::uint64_t getUInt64(const char* p)
+    {
+      boost::uint64_t v = 0;
+      for (int k=7; k>=0; --k)
+        v = (v << 8) | boost::uint64_t((unsigned char)p[k]);
+      return v;
+    }
+
+    boost::uint32_t getUInt32(const char* p)
+    {
+      boost::uint32_t v = 0;
+      for (int k=3; k>=0; --k)
+        v = (v << 8) | boost::uint32_t((unsigned char)p[k]);
+      return v;
+    }
+
+    double getDouble(const char* p)
+    {
+      boost::uint64_t v = getUInt64(p);
+      double d;
+      std::memcpy(&d, &v, sizeof(d));
+      return d;
+    }
+
+    vector3d getVector(const char* p)
+    {
+      return vector3d(getDouble(p), getDouble(p+8), getDouble(p+16));
+    }
+
+    void getSphere(const char* p, VVRsphere& sphere)
+    {
+      sphere._radius = getDouble(p);
+      sphere._center = getVector(p+8);
+    }
+
+    void getCone(const char* p, VVRcone& cone)
+    {
+      cone.second._cosangle = getDouble(p);
+      cone.second._axis = getVector(p+8);
+      cone.first = int(getUInt32(p+32));
+    }
+
+    void getPlane(const char* p, VVRplane& plane)
+    {
+      plane.second = getVector(p);
+      plane.first = int(getUInt32(p+24));
+    }
+
+    //the text of a double is the one of an ostream of precision 16 : printf's %.16g
+    void appendDouble(std::string& text, double d)
+    {
+      char buffer[32];
+#ifdef SCD_TO_CHARS
+      char* last = std::to_chars(buffer, buffer+sizeof(buffer), d, std::chars_format::general, 16).ptr;
+#else
+      char* last = buffer + std::sprintf(buffer, "%.16g", d);
+#endif
+      text.append(buffer, last);
+    }
+
+    void appendInt(std::string& text, long n)
+    {
+      char buffer[24];
+#ifdef SCD_TO_CHARS
+      char* last = std::to_chars(buffer, buffer+sizeof(buffer), n).ptr;
+#else
+      char* last = buffer + std::sprintf(buffer, "%ld", n);
+#endif
+      text.append(buffer, last);
+    }
+
+    void appendVector(std::string& text, const vector3d& v)
+    {
+      appendDouble(text, v.x);
+      text += ' ';
+      appendDouble(text, v.y);
+      text += ' ';
+      appendDouble(text, v.z);
+    }
+
+    //patch id followed by its limit
+    void appendCone(std::string& text, const VVRcone& cone)
+    {
+      appendInt(text, cone.first);
+      text += ' ';
+      appendDouble(text, cone.second._cosangle);
+      text += ' ';
+      appendVector(text, cone.second._axis);
+      text += '\n';
+    }
+
+    void appendPlane(std::string& text, const VVRplane& plane)
+    {
+      appendInt(text, plane.first);
+      text += ' ';
+      appendVector(text, plane.second);
+      text += '\n';
+    }
+
+    void appendSphere(std::string& text, const VVRsphere& sphere)
+    {
+      appendDouble(text, sphere._radius);
+      text += ' ';
+      appendVector(text, sphere._center);
+      text += '\n';
+    }
+
+    void formatSmallSpheres(const STPBV& stpbv, std::string& text)
+    {
+      text.reserve(stpbv._smallSpheres.size()*400);
+      text += ' ';
+      appendInt(text, long(stpbv._smallSpheres.size()));
+      text += '\n';
+      for (std::vector<STPBVSmallSphere>::const_iterator it = stpbv._smallSpheres.begin() ; it != stpbv._smallSpheres.end() ; ++it)
+      {
+        appendSphere(text, it->_sphere);
+
+        //VVR
+        appendInt(text, long(it->_vvr.size()));
+        text += '\n';
+        for (std::vector<VVRcone>::const_iterator it2 = it->_vvr.begin() ; it2 != it->_vvr.end() ; ++it2)
+          appendCone(text, *it2);
+      }
+    }
+
+    void formatBigSpheres(const STPBV& stpbv, std::string& text)
+    {
+      text.reserve(stpbv._bigSpheres.size()*560);
+      appendInt(text, long(stpbv._bigSpheres.size()));
+      text += '\n';
+      for (std::vector<STPBVBigSphere>::const_iterator it = stpbv._bigSpheres.begin() ; it != stpbv._bigSpheres.end() ; ++it)
+      {
+        appendSphere(text, it->_sphere);
+        //face vertices
+        for (int k=0; k<3; ++k)
+        {
+          appendVector(text, it->_vertices[k]);
+          text += (k<2)?' ':'\n';
+        }
+
+        //VVR
+        appendPlane(text, it->_vvr._plane1);
+        appendPlane(text, it->_vvr._plane2);
+        appendPlane(text, it->_vvr._plane3);
+      }
+    }
+
+    void formatTori(const STPBV& stpbv, std::string& text)
+    {
+      text.reserve(stpbv._tori.size()*600);
+      appendInt(text, long(stpbv._tori.size()));
+      text += '\n';
+      for (std::vector<STPBVTorus>::const_iterator it = stpbv._tori.begin() ; it != stpbv._tori.end() ; ++it)
+      {
+        text += it->_used?"1\n":"0\n";
+        appendDouble(text, it->_torus._extRadius);
+        text += ' ';
+        appendDouble(text, it->_radius);
+        text += ' ';
+        appendVector(text, it->_torus._center);
+        text += ' ';
+        appendVector(text, it->_torus._normal);
+        text += '\n';
+
+        //VVR
+        for (int k=0; k<2; ++k)
+          appendCone(text, it->_cones[k]);
+        for (int k=0; k<2; ++k)
+          appendPlane(text, it->_planes[k]);
+      }
+    }
+
+    //the sections are formatted in memory, in parallel if they are large enough, and written at once
+    bool writeText(const STPBV& stpbv, const std::string& filename, std::ostream& log)
+    {
+      std::ofstream os(filename.c_str());
+      if (!os.is_open())
+      {
+        log << "unable to open file " << filename << std::endl;
+        return false;
+      }
+
+      std::string sections[4];
+      appendDouble(sections[0], stpbv._r);
+      sections[0] += ' ';
+      appendDouble(sections[0], stpbv._R);
+      sections[0] += '\n';
+
+      const std::size_t parallelThreshold = 1000;
+      bool parallel = stpbv._bigSpheres.size() >= parallelThreshold;
+#pragma omp parallel sections num_threads(3) if(parallel)
+      {
+#pragma omp section
+        formatSmallSpheres(stpbv, sections[1]);
+#pragma omp section
+        formatBigSpheres(stpbv, sections[2]);
+#pragma omp section
+        formatTori(stpbv, sections[3]);
+      }
+
+      for (int k=0; k<4; ++k)
+        os.write(sections[k].data(), std::streamsize(sections[k].size()));
+      os.close();
+      if (!os)
+        log << "unable to write file " << filename << std::endl;
+      return bool(os);
+    }
+
+    bool writeBinary(const STPBV& stpbv, const std::string& filename, std::ostream& log)
+    {
+      std::ofstream os(filename.c_str(), std::ios::binary);
+      if (!os.is_open())
+      {
+        log << "unable to open file " << filename << std::endl;
+        return false;
+      }
+
+      boost::uint64_t coneCount = 0;
+      for (unsigned int i=0; i<stpbv._smallSpheres.size(); ++i)
+        coneCount += stpbv._smallSpheres[i]._vvr.size();
+
+      STPBVBinaryHeader h;
+      h._smallSphereCount = stpbv._smallSpheres.size();
+      h._smallConeCount = coneCount;
+      h._bigSphereCount = stpbv._bigSpheres.size();
+      h._torusCount = stpbv._tori.size();
+      h._smallSpheresOffset = sizeof(STPBVBinaryHeader);
+      h._coneIndexOffset = h._smallSpheresOffset + h._smallSphereCount*sizeof(STPBVBinarySphere);
+      h._smallConesOffset = h._coneIndexOffset + (h._smallSphereCount+1)*sizeof(boost::uint64_t);
+      h._bigSpheresOffset = h._smallConesOffset + h._smallConeCount*sizeof(STPBVBinaryCone);
+      h._toriOffset = h._bigSpheresOffset + h._bigSphereCount*sizeof(STPBVBinaryBigSphere);
+      h._fileSize = h._toriOffset + h._torusCount*sizeof(STPBVBinaryTorus);
+
+      std::vector<char> buffer;
+      buffer.reserve(std::size_t(h._fileSize));
+      buffer.insert(buffer.end(), binaryMagic, binaryMagic+8);
+      putUInt32(buffer, STPBV_BINARY_VERSION);
+      putUInt32(buffer, sizeof(STPBVBinaryHeader));
+      putUInt64(buffer, h._fileSize);
+      putDouble(buffer, stpbv._r);
+      putDouble(buffer, stpbv._R);
+      putUInt64(buffer, h._smallSphereCount);
+      putUInt64(buffer, h._smallConeCount);
+      putUInt64(buffer, h._bigSphereCount);
+      putUInt64(buffer, h._torusCount);
+      putUInt64(buffer, h._smallSpheresOffset);
+      putUInt64(buffer, h._coneIndexOffset);
+      putUInt64(buffer, h._smallConesOffset);
+      putUInt64(buffer, h._bigSpheresOffset);
+      putUInt64(buffer, h._toriOffset);
+
+      for (unsigned int i=0; i<stpbv._smallSpheres.size(); ++i)
+        putSphere(buffer, stpbv._smallSpheres[i]._sphere);
+      boost::uint64_t first = 0;
+      putUInt64(buffer, first);
+      for (unsigned int i=0; i<stpbv._smallSpheres.size(); ++i)
+      {
+        first += stpbv._smallSpheres[i]._vvr.size();
+        putUInt64(buffer, first);
+      }
+      for (unsigned int i=0; i<stpbv._smallSpheres.size(); ++i)
+      {
+        for (unsigned int j=0; j<stpbv._smallSpheres[i]._vvr.size(); ++j)
+          putCone(buffer, stpbv._smallSpheres[i]._vvr[j]);
+      }
+
+      for (unsigned int i=0; i<stpbv._bigSpheres.size(); ++i)
+      {
+        const STPBVBigSphere& b = stpbv._bigSpheres[i];
+        putSphere(buffer, b._sphere);
+        for (int k=0; k<3; ++k)
+          putVector(buffer, b._vertices[k]);
+        putPlane(buffer, b._vvr._plane1);
+        putPlane(buffer, b._vvr._plane2);
+        putPlane(buffer, b._vvr._plane3);
+      }
+
+      for (unsigned int i=0; i<stpbv._tori.size(); ++i)
+      {
+        const STPBVTorus& t = stpbv._tori[i];
+        putDouble(buffer, t._torus._extRadius);
+        putDouble(buffer, t._radius);
+        putVector(buffer, t._torus._center);
+        putVector(buffer, t._torus._normal);
+        for (int k=0; k<2; ++k)
+          putCone(buffer, t._cones[k]);
+        for (int k=0; k<2; ++k)
+          putPlane(buffer, t._planes[k]);
+        putUInt32(buffer, t._used?1:0);
+        putUInt32(buffer, 0);
+      }
+
+      os.write(&buffer[0], std::streamsize(buffer.size()));
+      os.close();
+      if (!os)
+        log << "unable to write file " << filename << std::endl;
+      return bool(os);
+    }
+
+    bool readText(STPBV& stpbv, const std::string& filename, std::ostream& log)
+    {
+      std::ifstream is(filename.c_str());
+      if (!is.is_open())
+      {
+        log << "unable to open file " << filename << std::endl;
+        return false;
+      }
+
+      stpbv = STPBV();
+      unsigned int n;
+      is >> stpbv._r >> stpbv._R >> n;
+      stpbv._smallSpheres.resize(is?n:0);
+      for (unsigned int i=0; i<n && is; ++i)
+      {
+        STPBVSmallSphere& s = stpbv._smallSpheres[i];
+        unsigned int m;
+        is >> s._sphere._radius >> s._sphere._center.x >> s._sphere._center.y >> s._sphere._center.z >> m;
+        s._vvr.resize(is?m:0);
+        for (unsigned int j=0; j<m && is; ++j)
+        {
+          VVRcone& c = s._vvr[j];
+          is >> c.first >> c.second._cosangle >> c.second._axis.x >> c.second._axis.y >> c.second._axis.z;
+        }
+      }
+
+      is >> n;
+      stpbv._bigSpheres.resize(is?n:0);
+      for (unsigned int i=0; i<n && is; ++i)
+      {
+        STPBVBigSphere& b = stpbv._bigSpheres[i];
+        is >> b._sphere._radius >> b._sphere._center.x >> b._sphere._center.y >> b._sphere._center.z;
+        for (int k=0; k<3; ++k)
+          is >> b._vertices[k].x >> b._vertices[k].y >> b._vertices[k].z;
+        VVRplane* planes[3] = {&b._vvr._plane1, &b._vvr._plane2, &b._vvr._plane3};
+        for (int k=0; k<3; ++k)
+          is >> planes[k]->first >> planes[k]->second.x >> planes[k]->second.y >> planes[k]->second.z;
+      }
+
+      is >> n;
+      stpbv._tori.resize(is?n:0);
+      for (unsigned int i=0; i<n && is; ++i)
+      {
+        STPBVTorus& t = stpbv._tori[i];
+        is >> t._used >> t._torus._extRadius >> t._radius;
+        is >> t._torus._center.x >> t._torus._center.y >> t._torus._center.z;
+        is >> t._torus._normal.x >> t._torus._normal.y >> t._torus._normal.z;
+        for (int k=0; k<2; ++k)
+          is >> t._cones[k].first >> t._cones[k].second._cosangle >> t._cones[k].second._axis.x >> t._cones[k].second._axis.y >> t._cones[k].second._axis.z;
+        for (int k=0; k<2; ++k)
+          is >> t._planes[k].first >> t._planes[k].second.x >> t._planes[k].second.y >> t._planes[k].second.z;
+      }
+
+      if (!is)
+      {
+        log << "wrong STP-BV file " << filename << std::endl;
+        return false;
+      }
+      return true;
+    }
+
+    //the array of count records of the given size at offset lies in the file
+    bool inFile(boost::uint64_t offset, boost::uint64_t count, boost::uint64_t size, std::size_t fileSize)
+    {
+      return offset <= fileSize && offset % 8 == 0 && count <= (fileSize - offset) / size;
+    }
+
+    bool readBinary(STPBV& stpbv, const MappedFile& file, const std::string& filename, std::ostream& log)
+    {
+      const char* data = file.data();
+      std::size_t size = file.size();
+      if (getUInt32(data+8) != STPBV_BINARY_VERSION)
+      {
+        log << "unsupported version " << getUInt32(data+8) << " of the STP-BV file " << filename << std::endl;
+        return false;
+      }
+
+      boost::uint64_t smallCount = getUInt64(data+40);
+      boost::uint64_t coneCount = getUInt64(data+48);
+      boost::uint64_t bigCount = getUInt64(data+56);
+      boost::uint64_t torusCount = getUInt64(data+64);
+      boost::uint64_t smallOffset = getUInt64(data+72);
+      boost::uint64_t indexOffset = getUInt64(data+80);
+      boost::uint64_t coneOffset = getUInt64(data+88);
+      boost::uint64_t bigOffset = getUInt64(data+96);
+      boost::uint64_t torusOffset = getUInt64(data+104);
+      bool valid = getUInt32(data+12) >= sizeof(STPBVBinaryHeader) && getUInt64(data+16) == size
+                   && inFile(smallOffset, smallCount, sizeof(STPBVBinarySphere), size)
+                   && inFile(indexOffset, smallCount+1, sizeof(boost::uint64_t), size)
+                   && inFile(coneOffset, coneCount, sizeof(STPBVBinaryCone), size)
+                   && inFile(bigOffset, bigCount, sizeof(STPBVBinaryBigSphere), size)
+                   && inFile(torusOffset, torusCount, sizeof(STPBVBinaryTorus), size);
+      //the cones of the small spheres follow each other
+      for (boost::uint64_t i=0; valid && i<=smallCount; ++i)
+      {
+        boost::uint64_t first = getUInt64(data+indexOffset+8*i);
+        valid = (i>0 || first==0) && (i<smallCount || first==coneCount)
+                && (i==0 || first >= getUInt64(data+indexOffset+8*(i-1))) && first <= coneCount;
+      }
+      if (!valid)
+      {
+        log << "wrong STP-BV file " << filename << std::endl;
+        return false;
+      }
+
+      stpbv = STPBV();
+      stpbv._r = getDouble(data+24);
+      stpbv._R = getDouble(data+32);
+
+      stpbv._smallSpheres.resize(std::size_t(smallCount));
+      for (std::size_t i=0; i<smallCount; ++i)
+      {
+        STPBVSmallSphere& s = stpbv._smallSpheres[i];
+        getSphere(data+smallOffset+i*sizeof(STPBVBinarySphere), s._sphere);
+        boost::uint64_t first = getUInt64(data+indexOffset+8*i);
+        boost::uint64_t last = getUInt64(data+indexOffset+8*(i+1));
+        s._vvr.resize(std::size_t(last-first));
+        for (std::size_t j=0; j<s._vvr.size(); ++j)
+          getCone(data+coneOffset+(first+j)*sizeof(STPBVBinaryCone), s._vvr[j]);
+      }
+
+      stpbv._bigSpheres.resize(std::size_t(bigCount));
+      for (std::size_t i=0; i<bigCount; ++i)
+      {
+        STPBVBigSphere& b = stpbv._bigSpheres[i];
+        const char* p = data+bigOffset+i*sizeof(STPBVBinaryBigSphere);
+        getSphere(p, b._sphere);
+        for (int k=0; k<3; ++k)
+          b._vertices[k] = getVector(p+32+24*k);
+        getPlane(p+104, b._vvr._plane1);
+        getPlane(p+136, b._vvr._plane2);
+        getPlane(p+168, b._vvr._plane3);
+      }
+
+      stpbv._tori.resize(std::size_t(torusCount));
+      for (std::size_t i=0; i<torusCount; ++i)
+      {
+        STPBVTorus& t = stpbv._tori[i];
+        const char* p = data+torusOffset+i*sizeof(STPBVBinaryTorus);
+        t._torus._extRadius = getDouble(p);
+        t._radius = getDouble(p+8);
+        t._torus._center = getVector(p+16);
+        t._torus._normal = getVector(p+40);
+        for (int k=0; k<2; ++k)
+          getCone(p+64+40*k, t._cones[k]);
+        for (int k=0; k<2; ++k)
+          getPlane(p+144+32*k, t._planes[k]);
+        t._used = getUInt32(p+208) != 0;
+      }
+      return true;
+    }
+  }
+
+  bool writeSTPBV(const STPBV& stpbv, const std::string& filename, STPBVFormat format, std::ostream& log)
+  {
+    if (format == STPBV_BINARY)
+      return writeBinary(stpbv, filename, log);
+    return writeText(stpbv, filename, log);
+  }
+
+  bool readSTPBV(STPBV& stpbv, const std::string& filename, std::ostream& log)
+  {
+    MappedFile file(filename);
+    if (!file.isOpen())
+    {
+      log << "unable to open file " << filename << std::endl;
+      return false;
+    }
+    if (file.size() >= sizeof(STPBVBinaryHeader) && std::memcmp(file.data(), binaryMagic, 8) == 0)
+      return readBinary(stpbv, file, filename, log);
+    return readText(stpbv, filename, log);
+  }
+}
@@ -0,0 +1,243 @@
+/*! \file STPBV.h
+ *  \brief Declaration file of the STP-BV description
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_STPBV_H
+#define SCD_STPBV_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <iostream>
+#include <boost/cstdint.hpp>
+
+#include "vector3.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+
+  /*! \class VVRsphere
+   *	\brief %Class VVRsphere
+   *	\author Cochet-Grasset Amelie
+   *	\version 0.0.0
+   *	\date 07.10.22
+   *	\bug None
+   *	\warning None
+   *
+   * A sphere
+   */
+  struct VVRsphere
+  {
+    double		_radius;
+    vector3d		_center;
+  };
+
+  /*! \class VVRtorus
+   *	\brief %Class VVRtorus
+   *	\author Cochet-Grasset Amelie
+   *	\version 0.0.0
+   *	\date 07.10.22
+   *	\bug None
+   *	\warning None
+   *
+   * A Torus without the inner radius
+   */
+  struct VVRtorus
+  {
+    double		_extRadius;
+    vector3d	_center;
+    vector3d		_normal;
+  };
+
+  /*! \class Cone
+   *	\brief %Class Cone
+   *	\author Cochet-Grasset Amelie
+   *	\version 0.0.0
+   *	\date 07.07
+   *	\bug None
+   *	\warning None
+   *
+   * A sphere
+   */
+  struct Cone
+  {
+    double _cosangle;
+    vector3d		 _axis;
+  };
+
+  typedef std::pair<int, vector3d> VVRplane;
+  typedef std::pair<int, Cone> VVRcone;
+
+  struct faceVVR
+  {
+    VVRplane _plane1;
+    VVRplane _plane2;
+    VVRplane _plane3;
+  };
+
+  /*! \class STPBVSmallSphere
+   *	\brief %Class STPBVSmallSphere
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * A small sphere of an STP-BV, on a vertex, and the cones bounding its Voronoi region
+   * (with the ids of the tori on the other side)
+   */
+  struct STPBVSmallSphere
+  {
+    VVRsphere				_sphere;
+    std::vector<VVRcone>	_vvr;
+  };
+
+  /*! \class STPBVBigSphere
+   *	\brief %Class STPBVBigSphere
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * A big sphere of an STP-BV, the vertices of its face and the planes bounding its Voronoi region
+   * (with the ids of the patches on the other side)
+   */
+  struct STPBVBigSphere
+  {
+    VVRsphere	_sphere;
+    vector3d	_vertices[3];
+    faceVVR		_vvr;
+  };
+
+  /*! \class STPBVTorus
+   *	\brief %Class STPBVTorus
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * A torus of an STP-BV, on an edge, with the cones and the planes bounding its Voronoi region. The
+   * tori between two big spheres of the same center are flat, they are kept but not used
+   */
+  struct STPBVTorus
+  {
+    bool		_used;
+    VVRtorus	_torus;
+    double		_radius;		//inner radius of the torus, R
+    VVRcone		_cones[2];		//with the ids of the small spheres
+    VVRplane	_planes[2];		//with the ids of the big spheres
+  };
+
+  /*! \class STPBV
+   *	\brief %Class STPBV
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Sphere-Torus Patches Bounding Volume, as written in the files of sch-core. The patches are
+   * identified by their rank in the small spheres, then the big spheres and then the tori
+   */
+  struct STPBV
+  {
+    double							_r;
+    double							_R;
+    std::vector<STPBVSmallSphere>	_smallSpheres;
+    std::vector<STPBVBigSphere>		_bigSpheres;
+    std::vector<STPBVTorus>			_tori;
+  };
+
+  enum STPBVFormat
+  {
+    STPBV_TEXT,				//decimal text read by sch-core
+    STPBV_BINARY			//binary, see STPBVBinaryHeader
+  };
+
+  /*! \class STPBVBinaryHeader
+   *	\brief %Class STPBVBinaryHeader
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Header of the binary format of an STP-BV. The file is little-endian and made of records whose
+   * fields are all aligned on their size, without implicit padding : on a little-endian host, the
+   * file mapped in memory can be used in place through the STPBVBinary structs. The header is followed
+   * by the arrays, at the offsets (in bytes from the start of the file, multiples of 8) it gives :
+   *  - the small spheres, STPBVBinarySphere[_smallSphereCount]
+   *  - the first cone of each small sphere, boost::uint64_t[_smallSphereCount+1] : the cones of the
+   *    small sphere i are [coneIndex[i], coneIndex[i+1]) in
+   *  - the cones of all the small spheres, STPBVBinaryCone[_smallConeCount]
+   *  - the big spheres, STPBVBinaryBigSphere[_bigSphereCount]
+   *  - the tori, STPBVBinaryTorus[_torusCount]
+   * The ids of the patches are the ones of the text format. A reader must check the magic and the
+   * version, and read the arrays at their offsets : the header may grow in the next versions
+   */
+  struct STPBVBinaryHeader
+  {
+    char			_magic[8];				//"STPBVBIN"
+    boost::uint32_t	_version;				//STPBV_BINARY_VERSION
+    boost::uint32_t	_headerSize;			//sizeof(STPBVBinaryHeader)
+    boost::uint64_t	_fileSize;
+    double			_r;
+    double			_R;
+    boost::uint64_t	_smallSphereCount;
+    boost::uint64_t	_smallConeCount;
+    boost::uint64_t	_bigSphereCount;
+    boost::uint64_t	_torusCount;
+    boost::uint64_t	_smallSpheresOffset;
+    boost::uint64_t	_coneIndexOffset;
+    boost::uint64_t	_smallConesOffset;
+    boost::uint64_t	_bigSpheresOffset;
+    boost::uint64_t	_toriOffset;
+  };
+
+  const boost::uint32_t STPBV_BINARY_VERSION = 1;
+
+  struct STPBVBinarySphere
+  {
+    double			_radius;
+    double			_center[3];
+  };
+
+  struct STPBVBinaryCone
+  {
+    double			_cosangle;
+    double			_axis[3];
+    boost::int32_t	_id;
+    boost::int32_t	_padding;
+  };
+
+  struct STPBVBinaryPlane
+  {
+    double			_normal[3];
+    boost::int32_t	_id;
+    boost::int32_t	_padding;
+  };
+
+  struct STPBVBinaryBigSphere
+  {
+    STPBVBinarySphere	_sphere;
+    double				_vertices[3][3];
+    STPBVBinaryPlane	_planes[3];
+  };
+
+  struct STPBVBinaryTorus
+  {
+    double				_extRadius;
+    double				_radius;
+    double				_center[3];
+    double				_normal[3];
+    STPBVBinaryCone		_cones[2];
+    STPBVBinaryPlane	_planes[2];
+    boost::int32_t		_used;
+    boost::int32_t		_padding;
+  };
+
+  //write the STP-BV in the given format. Returns false, with a message on log, if the file can't be written
+  bool writeSTPBV(const STPBV& stpbv, const std::string& filename, STPBVFormat format = STPBV_TEXT,
+                  std::ostream& log = std::cout);
+  //read an STP-BV written in any format, recognized from its content. Returns false, with a
+  //message on log, if the file can't be opened or is not a valid STP-BV
+  bool readSTPBV(STPBV& stpbv, const std::string& filename, std::ostream& log = std::cout);
+}
+
+#endif	//SCD_STPBV_H
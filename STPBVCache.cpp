@@ -0,0 +1,228 @@
+#include "STPBVCache.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace SCD
+{
+  namespace
+  {
+    boost::uint64_t rotl(boost::uint64_t x, int r)
+    {
+      return (x << r) | (x >> (64 - r));
+    }
+
+    boost::uint64_t fmix(boost::uint64_t k)
+    {
+      k ^= k >> 33;
+      k *= 0xff51afd7ed558ccdULL;
+      k ^= k >> 33;
+      k *= 0xc4ceb9fe1a85ec53ULL;
+      k ^= k >> 33;
+      return k;
+    }
+
+    //MurmurHash3_x64_128 of a sequence of 64 bits words, by blocks of two words
+    class wordHash
+    {
+    public:
+      wordHash(): _h1(0), _h2(0), _count(0), _pending(0) {}
+
+      void add(boost::uint64_t w)
+      {
+        if (_count++ % 2 == 0)
+        {
+          _pending = w;
+          return;
+        }
+        block(_pending, w);
+      }
+
+      void add(double d)
+      {
+        boost::uint64_t w;
+        std::memcpy(&w, &d, sizeof(w));
+        add(w);
+      }
+
+      std::string hex()
+      {
+        if (_count % 2 == 1)
+          block(_pending, 0);
+        boost::uint64_t h1 = _h1 ^ (8*_count);
+        boost::uint64_t h2 = _h2 ^ (8*_count);
+        h1 += h2;
+        h2 += h1;
+        h1 = fmix(h1);
+        h2 = fmix(h2);
+        h1 += h2;
+        h2 += h1;
+        const char digits[] = "0123456789abcdef";
+        std::string s(32, '0');
+        for (int k=0; k<16; ++k)
+        {
+          s[15-k] = digits[(h1 >> (4*k)) & 0xf];
+          s[31-k] = digits[(h2 >> (4*k)) & 0xf];
+        }
+        return s;
+      }
+
+    private:
+      void block(boost::uint64_t k1, boost::uint64_t k2)
+      {
+        const boost::uint64_t c1 = 0x87c37b91114253d5ULL;
+        const boost::uint64_t c2 = 0x4cf5ad432745937fULL;
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        _h1 ^= k1;
+        _h1 = rotl(_h1, 27);
+        _h1 += _h2;
+        _h1 = _h1*5 + 0x52dce729;
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        _h2 ^= k2;
+        _h2 = rotl(_h2, 31);
+        _h2 += _h1;
+        _h2 = _h2*5 + 0x38495ab5;
+      }
+
+    private:
+      boost::uint64_t	_h1;
+      boost::uint64_t	_h2;
+      boost::uint64_t	_count;
+      boost::uint64_t	_pending;
+    };
+
+    struct cacheFile
+    {
+      std::time_t		_lastUse;
+      boost::uint64_t	_size;
+      fs::path		_path;
+      bool operator<(const cacheFile& f) const
+      {
+        return _lastUse < f._lastUse;
+      }
+    };
+  }
+
+  STPBVCache::STPBVCache(const std::string& directory, boost::uint64_t maxSize, std::ostream& log):
+    _directory(directory),
+    _maxSize(maxSize),
+    _log(&log)
+  {
+  }
+
+  std::string STPBVCache::key(const std::vector<vector3d>& points, double r, double R, bool hullFilter)
+  {
+    wordHash h;
+    h.add(boost::uint64_t(STPBV_GENERATOR_VERSION));
+    h.add(r);
+    h.add(R);
+    h.add(boost::uint64_t(hullFilter));
+    h.add(boost::uint64_t(points.size()));
+    for (unsigned int i=0; i<points.size(); ++i)
+    {
+      h.add(points[i].x);
+      h.add(points[i].y);
+      h.add(points[i].z);
+    }
+    return h.hex();
+  }
+
+  std::string STPBVCache::defaultDirectory()
+  {
+    const char* cache = std::getenv("SCH_CREATOR_CACHE");
+    if (cache && *cache)
+      return cache;
+    fs::path directory;
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (xdg && *xdg)
+      directory = fs::path(xdg);
+    else if (home && *home)
+      directory = fs::path(home) / ".cache";
+    else
+      directory = fs::temp_directory_path();
+    return (directory / "sch_creator").string();
+  }
+
+  bool STPBVCache::load(const std::string& key, STPBV& stpbv) const
+  {
+    fs::path file = fs::path(_directory) / (key + ".stpbv");
+    boost::system::error_code ec;
+    if (!fs::is_regular_file(file, ec))
+      return false;
+    if (!readSTPBV(stpbv, file.string(), *_log))
+    {
+      fs::remove(file, ec);
+      return false;
+    }
+    fs::last_write_time(file, std::time(0), ec);
+    return true;
+  }
+
+  bool STPBVCache::store(const std::string& key, const STPBV& stpbv) const
+  {
+    boost::system::error_code ec;
+    fs::create_directories(_directory, ec);
+    fs::path file = fs::path(_directory) / (key + ".stpbv");
+    fs::path tmp = fs::path(_directory) / fs::unique_path(key + ".%%%%%%%%.tmp", ec);
+    if (ec || !writeSTPBV(stpbv, tmp.string(), STPBV_BINARY, *_log))
+    {
+      *_log << "WARNING, unable to write the STP-BV in the cache " << _directory << std::endl;
+      //a partial file is not left in the cache
+      if (!ec)
+        fs::remove(tmp, ec);
+      return false;
+    }
+    fs::rename(tmp, file, ec);
+    if (ec)
+    {
+      *_log << "WARNING, unable to write the STP-BV in the cache " << _directory << ": " << ec.message() << std::endl;
+      fs::remove(tmp, ec);
+      return false;
+    }
+    evict(file);
+    return true;
+  }
+
+  void STPBVCache::evict(const boost::filesystem::path& kept) const
+  {
+    std::vector<cacheFile> files;
+    boost::system::error_code ec;
+    boost::uint64_t size = fs::file_size(kept, ec);
+    if (ec)
+      size = 0;
+    for (fs::directory_iterator it(_directory, ec), end; it != end && !ec; it.increment(ec))
+    {
+      cacheFile f;
+      f._path = it->path();
+      if (f._path.extension() != ".stpbv" || f._path == kept)
+        continue;
+      f._size = fs::file_size(f._path, ec);
+      f._lastUse = fs::last_write_time(f._path, ec);
+      if (ec)
+      {
+        ec.clear();
+        continue;
+      }
+      size += f._size;
+      files.push_back(f);
+    }
+
+    //the least recently used first
+    std::sort(files.begin(), files.end());
+    for (unsigned int i=0; i<files.size() && size > _maxSize; ++i)
+    {
+      fs::remove(files[i]._path, ec);
+      size -= files[i]._size;
+    }
+  }
+}
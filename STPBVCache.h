@@ -0,0 +1,63 @@
+/*! \file STPBVCache.h
+ *  \brief Declaration file of the Class STPBVCache
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_STPBV_CACHE_H
+#define SCD_STPBV_CACHE_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "STPBV.h"
+
+namespace SCD
+{
+  //to increase when the STP-BV computed for a cloud changes, so that the cached ones are not served anymore
+  const boost::uint32_t STPBV_GENERATOR_VERSION = 1;
+
+  /*! \class STPBVCache
+   *	\brief %Class STPBVCache
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Directory of the STP-BV computed, in the binary format, named by the hash of what they depend on : the
+   * points of the cloud (in their order), the radii, the hull filter and the version of the generator. The files are written
+   * at once (through a temporary file) and the least recently used ones are removed beyond the size limit, the
+   * last one stored being kept. Several processes, or threads, can share the directory
+   */
+  class STPBVCache
+  {
+  public:
+    //maxSize in bytes, the warnings are written to log
+    STPBVCache(const std::string& directory, boost::uint64_t maxSize, std::ostream& log = std::cout);
+
+  public:
+    //128 bits hash (MurmurHash3), in hexadecimal. It is not cryptographic. The hull filter can change the
+    //order of the patches (see SmoothHullGeneratorVVR::setHullFilter)
+    static std::string	key(const std::vector<vector3d>& points, double r, double R, bool hullFilter);
+    //$SCH_CREATOR_CACHE if it is set, otherwise sch_creator in $XDG_CACHE_HOME or ~/.cache
+    static std::string	defaultDirectory();
+    //the STP-BV of the key, if it is in the cache, which is then its last use
+    bool	load(const std::string& key, STPBV& stpbv) const;
+    //returns false, with a warning, if the STP-BV can't be written
+    bool	store(const std::string& key, const STPBV& stpbv) const;
+
+  private:
+    //remove the least recently used files beyond the size limit, except the one just stored
+    void	evict(const boost::filesystem::path& kept) const;
+
+  private:
+    std::string		_directory;
+    boost::uint64_t	_maxSize;
+    std::ostream*	_log;
+  };
+}
+
+#endif	//SCD_STPBV_CACHE_H
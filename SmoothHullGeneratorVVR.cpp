@@ -1,7 +1,15 @@
 #include "SmoothHullGeneratorVVR.h"
+#include "CloudFile.h"
+#include "ConvexHull.h"
+#include "EdgeFront.h"
+#include "PointGrid.h"
+#include "STPBVCache.h"
 #include <iostream>
 #include <fstream>
 #include <limits>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 //#include <process.h>
 
 
@@ -12,8 +20,39 @@ namespace SCD
 
 
   SmoothHullGeneratorVVR::SmoothHullGeneratorVVR(double r, double R):
-    _epsilon(1e-8),
-    _ccw (false)
+    _predicates(_points, R - r),
+    _kernels(&sphereKernels()),
+    _ccw (false),
+    _hullFilter(true),
+    _threads(1),
+    _speculation(0),
+    _mixed(false),
+    _weld(-1.),
+    _decimationTolerance(0.),
+    _decimationCount(0),
+    _format(STPBV_TEXT),
+    _cacheSize(0),
+    _output(&std::cout)
+  {
+    _r = r;
+    _R = R;
+  }
+
+  SmoothHullGeneratorVVR::SmoothHullGeneratorVVR(const std::vector<vector3d>& points, double r, double R):
+    _points(points),
+    _predicates(_points, R - r),
+    _kernels(&sphereKernels()),
+    _ccw (false),
+    _hullFilter(true),
+    _threads(1),
+    _speculation(0),
+    _mixed(false),
+    _weld(-1.),
+    _decimationTolerance(0.),
+    _decimationCount(0),
+    _format(STPBV_TEXT),
+    _cacheSize(0),
+    _output(&std::cout)
   {
     _r = r;
     _R = R;
@@ -46,7 +85,7 @@ namespace SCD
     if (nuv == 0)   // aligned points
     {
 #ifdef DISPLAY_INFO
-      std::cout << "WARNING, no sphere can fit on face made of 3 aligned points" << std::endl;
+      *_output << "WARNING, no sphere can fit on face made of 3 aligned points" << std::endl;
 #endif
       return false;
     }
@@ -55,7 +94,7 @@ namespace SCD
     if (((_R-_r)*(_R-_r)-a*a*nu-b*b*nv-2*a*b*duv)/nuv<=0)
     {
 #ifdef DISPLAY_INFO
-      //std::cout << "WARNING, no sphere of radius " << _R << " can fit on face "  << p1 << " " << p2 << " " << p3 << std::endl;
+      //*_output << "WARNING, no sphere of radius " << _R << " can fit on face "  << p1 << " " << p2 << " " << p3 << std::endl;
 #endif
       return false;
     }
@@ -69,26 +108,36 @@ namespace SCD
   }
 
 
-  bool SmoothHullGeneratorVVR::isInSphere(vector3d &point, vector3d &center)
-  {
-    vector3d v(point,center);
-    bool res = (v.normsquared() <= ((_R - _r) * (_R - _r) * (1.+_epsilon)));
-    return res;
-  }
-
   double SmoothHullGeneratorVVR::distInSphere(vector3d &point, vector3d &center)
   {
     vector3d v(point,center);
     return (v.normsquared() - ((_R - _r) * (_R - _r)));// * (1.+_epsilon)));
   }
-  bool SmoothHullGeneratorVVR::allPointsInSphere(vector3d &center)
+  bool SmoothHullGeneratorVVR::containsAll(int a, int b, int d, int& witness)
   {
-    bool b = true;
-    for (unsigned int l=0; l<_points.size() && b; ++l)
+    vector3d center;
+    double error;
+    if (!_predicates.center(a, b, d, center, error))
+      return false;
+
+    //the squared distances to the approximate center decide the points farther than rho+error (out) and
+    //closer than rho-error (in), with a margin for their rounding. The points in between are tested exactly
+    double rho = _R - _r;
+    double out2 = (rho+error)*(rho+error)*(1+1e-14);
+    double in2 = (error < rho)?(rho-error)*(rho-error)*(1-1e-14):0.;
+    if (witness >= 0 && witness != a && witness != b && witness != d)
     {
-      b = isInSphere(_points[l],center);
+      double dist2 = (_points[witness]-center).normsquared();
+      if (dist2 > out2 || (dist2 > in2 && _predicates.side(a, b, d, witness) > 0))
+        return false;
     }
-    return b;
+    witness = _tree.findBeyond(center, out2);
+    if (witness >= 0)
+      return false;
+    std::vector<int> band;
+    _tree.beyond(center, in2, band);
+    witness = _predicates.outside(a, b, d, band);
+    return witness < 0;
   }
 
   bool SmoothHullGeneratorVVR::findFirstTriangle(unsigned &i,unsigned &j,unsigned &k, vector3d &c)
@@ -96,6 +145,7 @@ namespace SCD
     unsigned int n = _points.size();
 
     bool b = false;
+    int witness = -1;
     for (i=0; i<n; ++i)
     {
       for (j=i+1; j<n; ++j)
@@ -104,11 +154,11 @@ namespace SCD
         {
           //let's test if every point is inside the sphere [i,j,k]
           if (findCenter(i, j, k, c))
-            b = allPointsInSphere(c);
+            b = containsAll(i, j, k, witness);
           if (b) break;
           //now let's test if every point is inside the sphere [i,k,j]
           if (findCenter(i, k, j, c))
-            b = allPointsInSphere(c);
+            b = containsAll(i, k, j, witness);
           if (b)
           {
             _ccw = false;
@@ -122,25 +172,206 @@ namespace SCD
     return b;
   }
 
-  double SmoothHullGeneratorVVR::distMaxPointsInSphere(vector3d &center)
+  namespace
+  {
+    //below this number of points, the loops over the candidates are not worth sharing between threads
+    const int parallelThreshold = 512;
+
+    //state of the sphere of a candidate vertex in the pivot workspace, the first three are the ones
+    //of the float kernel
+    const char noSphere = 0;
+    const char approximateSphere = 1;		//only the float half tangent and its error are known
+    const char undecidedSphere = 2;
+    const char exactSphere = 3;
+
+    //lower bound of the pseudo angle s(1-cos(t)) of the double kernel knowing tan(t/2) >= tau :
+    //2tau|tau|/(1+tau^2), minus a margin for the rounding of the double computation
+    double lowerPseudoAngle(float tau, float error)
+    {
+      double t = double(tau)-double(error);
+      return 2*t*fabs(t)/(1+t*t) - 1e-12 - 1e-6*error;
+    }
+
+    //smallest angle t in [0,2pi[ for which A.cos(t)+B.sin(t) becomes greater than K, knowing that
+    //A<=K (t=0 is inside). Returns a value larger than 2pi if it never happens
+    double firstCrossing(double A, double B, double K)
+    {
+      const double twoPi = 2*acos(-1.);
+      double M = sqrt(A*A+B*B);
+      if (K >= M)
+        return 2*twoPi;
+      double t = atan2(B,A) - acos(std::max(-1., K/M));
+      while (t < 0)
+        t += twoPi;
+      //a point on the border which is immediately left
+      if (t > twoPi*(1-1e-12) && B > 0)
+        t = 0;
+      return t;
+    }
+  }
+
+  unsigned int SmoothHullGeneratorVVR::farthestPoint(vector3d &center)
+  {
+    double dist2;
+    return _tree.farthest(center, dist2);
+  }
+
+  bool SmoothHullGeneratorVVR::findSeedTriangle(unsigned &i,unsigned &j,unsigned &k, vector3d &c)
   {
-    double err;
-    double err_max = -(_R-_r)*(_R-_r);
-    for (unsigned int l=0; l<_points.size(); ++l)
+    /**
+     *The valid centers are those of the balls of radius R-r containing all the points.
+     *Starting from one of them, the ball is translated until a point i reaches its border,
+     *then rotated around i until a point j reaches it, and at last rotated around [i,j]
+     *until a third point k does : [i,j,k] is a face of the STP-BV.
+     *Each step is a single pass on the cloud.
+     */
+    const double twoPi = 2*acos(-1.);
+    unsigned int n = _points.size();
+    double rho = _R-_r;
+    if (n < 3)
+      return false;
+
+    // 0 - a ball containing the cloud, centered on the bounding box and moved toward
+    // the minimum enclosing ball (Badoiu-Clarkson) if needed
+    vector3d pmin(_points[0]), pmax(_points[0]);
+    for (unsigned int l=1; l<n; ++l)
     {
-      err = distInSphere(_points[l],center);
-      if (err>err_max)
-        err_max = err;
-      if (err<=-(_R-_r)*(_R-_r))
+      for (int m=0; m<3; ++m)
       {
-        std::cout << "PROBLEM, point at center ? " << err << " center " << center << " point " << _points[l] << std::endl;
+        pmin[m] = std::min(pmin[m], _points[l][m]);
+        pmax[m] = std::max(pmax[m], _points[l][m]);
+      }
+    }
+    vector3d c0 = (pmin+pmax)/2;
+    unsigned int f = farthestPoint(c0);
+    for (unsigned int t=1; t<1000 && (_points[f]-c0).normsquared() >= rho*rho; ++t)
+    {
+      c0 += (_points[f]-c0)/(t+1);
+      f = farthestPoint(c0);
+    }
+    if ((_points[f]-c0).normsquared() >= rho*rho)
+      return false;
+
+    // 1 - translate the ball away from its farthest point, until a point reaches its border
+    vector3d d = _points[f]-c0;
+    if (d.normsquared() == 0)
+      d = vector3d(1,0,0);
+    d.normalize();
+    double tmin = std::numeric_limits<double>::max();
+    for (unsigned int l=0; l<n; ++l)
+    {
+      vector3d w = c0-_points[l];
+      double b = d%w;
+      double t = b + sqrt(std::max(0., b*b - w.normsquared() + rho*rho));
+      if (t < tmin)
+      {
+        tmin = t;
+        i = l;
+      }
+    }
+    vector3d c1 = c0 - d*tmin;
+
+    // 2 - rotate the ball around i
+    vector3d a = (c1-_points[i])/rho;
+    vector3d e = a^vector3d(1,0,0);
+    if (e.normsquared() < 1e-2)
+      e = a^vector3d(0,1,0);
+    e.normalize();
+    tmin = 2*twoPi;
+    for (unsigned int l=0; l<n; ++l)
+    {
+      if (l != i)
+      {
+        vector3d w = _points[i]-_points[l];
+        double t = firstCrossing(w%a, w%e, -w.normsquared()/(2*rho));
+        if (t < tmin)
+        {
+          tmin = t;
+          j = l;
+        }
       }
     }
+    if (tmin > twoPi)
+      return false;
+    vector3d c2 = _points[i] + (a*cos(tmin) + e*sin(tmin))*rho;
+
+    // 3 - rotate the ball around [i,j]
+    vector3d m = (_points[i]+_points[j])/2;
+    vector3d axis = _points[j]-_points[i];
+    double h2 = rho*rho - axis.normsquared()/4;
+    axis.normalize();
+    a = c2-m;
+    a -= axis*(a%axis);
+    if (h2 <= 0 || a.normsquared() == 0)
+      return false;
+    a.normalize();
+    double h = sqrt(h2);
+    vector3d b = axis^a;
+    tmin = 2*twoPi;
+    for (unsigned int l=0; l<n; ++l)
+    {
+      if (l != i && l != j)
+      {
+        vector3d w = m-_points[l];
+        double t = firstCrossing(w%a, w%b, (rho*rho - h2 - w.normsquared())/(2*h));
+        if (t < tmin)
+        {
+          tmin = t;
+          k = l;
+        }
+      }
+    }
+    if (tmin > twoPi)
+      return false;
+    vector3d c3 = m + (a*cos(tmin) + b*sin(tmin))*h;
+
+    //the triangle is oriented such that findCenter gives back the center we reached
+    vector3d cijk, cikj;
+    bool bijk = findCenter(i, j, k, cijk);
+    bool bikj = findCenter(i, k, j, cikj);
+    if (!bijk && !bikj)
+      return false;
+    if (!bijk || (bikj && (cikj-c3).normsquared() < (cijk-c3).normsquared()))
+    {
+      std::swap(j,k);
+      cijk = cikj;
+    }
+    c = cijk;
+    _ccw = true;
+
+    // 4 - the rolling is computed with rounding errors, the point reached last may be a wrong one. The
+    // exact rotation around each edge of the triangle then gives a face, if the edge is one of the STP-BV
+    int witness = -1;
+    if (containsAll(i, j, k, witness))
+      return true;
+    unsigned int tri[3][3] = {{i,j,k},{j,k,i},{k,i,j}};
+    for (int t=0; t<3; ++t)
+    {
+      turnData td = {int(tri[t][0]), int(tri[t][1]), int(tri[t][2]), c};
+      edgePivot ep;
+      computePivot(td, ep, _workspace);
+      if (ep._point >= 0)
+      {
+        i = td._p1;
+        j = ep._point;
+        k = td._p2;
+        c = ep._center;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  double SmoothHullGeneratorVVR::distMaxPointsInSphere(vector3d &center)
+  {
+    double dist2;
+    _tree.farthest(center, dist2);
+    double err_max = std::max(-(_R-_r)*(_R-_r), dist2 - ((_R - _r) * (_R - _r)));
     if (err_max==-(_R-_r)*(_R-_r))
     {
-      std::cout << "PROBLEM, all points at center ? " << " center " << center << " nb points " << _points.size() << std::endl;
+      *_output << "PROBLEM, all points at center ? " << " center " << center << " nb points " << _points.size() << std::endl;
     }
-    //std::cout << err_max << std::endl;
+    //*_output << err_max << std::endl;
     return err_max;
   }
 
@@ -152,7 +383,7 @@ namespace SCD
     if (cosinus > double(1))
     {
 #ifdef DISPLAY_INFO
-      std::cout << "ERROR in computing angle, found cos(angle)>1 " << cosinus << std::endl;
+      *_output << "ERROR in computing angle, found cos(angle)>1 " << cosinus << std::endl;
 #endif
       cosinus = 1;
       //return 0;
@@ -160,7 +391,7 @@ namespace SCD
     else if (cosinus < double(-1))
     {
 #ifdef DISPLAY_INFO
-      std::cout << "ERROR in computing angle, found cos(angle)<-1 " << cosinus << std::endl;
+      *_output << "ERROR in computing angle, found cos(angle)<-1 " << cosinus << std::endl;
 #endif
       cosinus = -1;
     }
@@ -169,39 +400,187 @@ namespace SCD
 //
   void SmoothHullGeneratorVVR::cover(void)
   {
-    unsigned int n = _points.size();
+    if (!_hullFilter && _warmStart.empty())
+    {
+      coverHullPoints();
+      return;
+    }
+
+    // 0 - only the vertices of the convex hull can be vertices of the STP-BV, and with a smaller R-r
+    //only the vertices of the STP-BV computed before
+    std::vector<int> hullIndex;
+    if (!_warmStart.empty())
+    {
+      hullIndex.swap(_warmStart);
+      *_output << "Vertices of the previous STP-BV kept " << hullIndex.size() << "/" << _points.size() << " points" << std::endl;
+    }
+    else
+    {
+      ConvexHull hull(_points);
+      if (!hull.compute())
+        *_output << "WARNING, degenerated convex hull, no point discarded" << std::endl;
+      hull.boundaryPoints(hullIndex);
+      if (hullIndex.size() == _points.size())
+      {
+        coverHullPoints();
+        return;
+      }
+      *_output << "Convex hull filter kept " << hullIndex.size() << "/" << _points.size() << " points" << std::endl;
+    }
 
+    std::vector<vector3d> cloud(hullIndex.size());
+    for (unsigned int i=0; i<hullIndex.size(); ++i)
+      cloud[i] = _points[hullIndex[i]];
+    _points.swap(cloud);
+    coverHullPoints();
+    _points.swap(cloud);
 
-    //look for largest distance
-    vector3d d;
-    double d_max = 0;
+    //come back to the indices of the whole cloud
+    for (unsigned int i=0; i<_spheres.size(); ++i)
+    {
+      _spheres[i]._point1 = hullIndex[_spheres[i]._point1];
+      _spheres[i]._point2 = hullIndex[_spheres[i]._point2];
+      _spheres[i]._point3 = hullIndex[_spheres[i]._point3];
+    }
+    std::set<int,std::less<int> > index;
+    for (std::set<int,std::less<int> >::iterator it=_index.begin(); it!=_index.end(); ++it)
+      index.insert(index.end(), hullIndex[*it]);
+    _index.swap(index);
+  }
+
+  void SmoothHullGeneratorVVR::setRadii(double r, double R)
+  {
+    _warmStart.clear();
+    if (R-r != _R-_r)
+    {
+      //a point on a sphere of radius R-r containing the cloud is on a larger sphere containing it too :
+      //the vertices of the STP-BV with a smaller R-r are among the ones of the current STP-BV
+      if (R-r < _R-_r && !_spheres.empty())
+        _warmStart.assign(_index.begin(), _index.end());
+      _index.clear();
+      _spheres.clear();
+      _predicates.setRadius(R-r);
+    }
+    _r = r;
+    _R = R;
+  }
+
+  void SmoothHullGeneratorVVR::setHullFilter(bool filter)
+  {
+    _hullFilter = filter;
+  }
+
+  void SmoothHullGeneratorVVR::setThreads(int threads)
+  {
+#ifdef _OPENMP
+    _threads = (threads > 0)?threads:omp_get_num_procs();
+#else
+    if (threads != 1)
+      *_output << "WARNING, built without OpenMP, the computation runs on one thread" << std::endl;
+    _threads = 1;
+#endif
+  }
+
+  void SmoothHullGeneratorVVR::setSpeculation(int edges)
+  {
+    _speculation = std::max(edges, 0);
+  }
+
+  void SmoothHullGeneratorVVR::setMixedPrecision(bool mixed)
+  {
+    _mixed = mixed;
+  }
+
+  void SmoothHullGeneratorVVR::setWelding(double tolerance)
+  {
+    _weld = tolerance;
+  }
+
+  void SmoothHullGeneratorVVR::setDecimation(double tolerance, unsigned int count)
+  {
+    _decimationTolerance = tolerance;
+    _decimationCount = count;
+  }
+
+  void SmoothHullGeneratorVVR::setOutputFormat(STPBVFormat format)
+  {
+    _format = format;
+  }
+
+  void SmoothHullGeneratorVVR::setCache(const std::string& directory, boost::uint64_t maxSize)
+  {
+    _cacheDirectory = directory;
+    _cacheSize = maxSize;
+  }
+
+  void SmoothHullGeneratorVVR::setOutput(std::ostream& os)
+  {
+    _output = &os;
+  }
+
+  void SmoothHullGeneratorVVR::coverHullPoints(void)
+  {
+    unsigned int n = _points.size();
+    _tree.build(_points);
+    _x.resize(n);
+    _y.resize(n);
+    _z.resize(n);
     for (unsigned i=0; i<n; ++i)
     {
-      for (unsigned j=i+1; j<n; ++j)
+      _x[i] = _points[i].x;
+      _y[i] = _points[i].y;
+      _z[i] = _points[i].z;
+    }
+    if (_mixed && n > 0)
+    {
+      vector3d pmin(_points[0]), pmax(_points[0]);
+      for (unsigned i=1; i<n; ++i)
       {
-        d = _points[i] - _points[j];
-        if (d_max<d.norm())
-          d_max = d.norm();
+        for (int m=0; m<3; ++m)
+        {
+          pmin[m] = std::min(pmin[m], _points[i][m]);
+          pmax[m] = std::max(pmax[m], _points[i][m]);
+        }
+      }
+      _origin = (pmin+pmax)/2;
+      double extent = std::max(pmax.x-pmin.x, std::max(pmax.y-pmin.y, pmax.z-pmin.z))/2;
+      _scale = (extent > 0)?1./extent:1.;
+      _xf.resize(n);
+      _yf.resize(n);
+      _zf.resize(n);
+      for (unsigned i=0; i<n; ++i)
+      {
+        _xf[i] = float((_points[i].x-_origin.x)*_scale);
+        _yf[i] = float((_points[i].y-_origin.y)*_scale);
+        _zf[i] = float((_points[i].z-_origin.z)*_scale);
       }
     }
-    std::cout << "Maximum body distance " << d_max << std::endl;
+
+    //look for largest distance
+    double d_max = 0;
+    for (unsigned i=0; i<n; ++i)
+    {
+      double dist2;
+      _tree.farthest(_points[i], dist2);
+      if (d_max<sqrt(dist2))
+        d_max = sqrt(dist2);
+    }
+    *_output << "Maximum body distance " << d_max << std::endl;
     if (d_max>=2.*(_R-_r))
-      std::cout << "ERROR, impossible to compute an STP-BV for this body with R=" << _R << ", choose larger R" << std::endl;
+      *_output << "ERROR, impossible to compute an STP-BV for this body with R=" << _R << ", choose larger R" << std::endl;
 
     // 1 - find a triangle to start with
-    std::cout << "Searching for initial triangle... ";
-    double epsilon_temp = _epsilon;
-    _epsilon = 0.; // should find an initial triangle with such epsilon
+    *_output << "Searching for initial triangle... ";
     bool b = false;
     _ccw = true;			//is the triangle describes by [i,j,k] counterclockwise
     unsigned int i,j,k;
     vector3d c;
 
-#if 1  // find the first matching triangle
-    if (!(b=findFirstTriangle(i,j,k,c)))
+#if 1  // find a matching triangle by rolling a ball on the cloud, or the first one by exhaustive search
+    if (!(b=findSeedTriangle(i,j,k,c)))
     {
-      _epsilon = 1e-8;
-      std::cout << "Failed" << std::endl <<  "trying with more compliant constraints... " ;
+      _ccw = true;
+      *_output << "Failed" << std::endl <<  "trying exhaustive search... " ;
       b=findFirstTriangle(i,j,k,c);
     }
 
@@ -248,19 +627,18 @@ namespace SCD
           }
         }
       }
-      std::cout << i << "/" << n << std::endl;
+      *_output << i << "/" << n << std::endl;
     }
     i = i_min;
     j = j_min;
     k = k_min;
     c = c_min;
-    std::cout << "best initial triangle " << i << " " << j << " " << k << " dist " << dist_min << std::endl;
+    *_output << "best initial triangle " << i << " " << j << " " << k << " dist " << dist_min << std::endl;
 #endif
-    _epsilon = epsilon_temp;
 
     if (!b)		//no initial triangle found
     {
-      std::cout << "failed" << std::endl;
+      *_output << "failed" << std::endl;
       return;
     }
 
@@ -270,8 +648,8 @@ namespace SCD
       j = k;
       k = e;
     }
-    std::cout << "found" << std::endl;
-    //		std::cout << i << ", " << j << ", " << k << std::endl;
+    *_output << "found" << std::endl;
+    //		*_output << i << ", " << j << ", " << k << std::endl;
     VVRSFace s = {i,j,k,c};
     _index.insert(i);
     _index.insert(j);
@@ -279,69 +657,301 @@ namespace SCD
     //		printSphere(s);
 
     // 2 - turn around the edge
-    std::cout << "Computing hull... ";
+    *_output << "Computing hull... ";
     travelCover(s);
     if (_spheres.size() != ((_index.size()-2)*2))
     {
-      std::cout << "WARNING : EULER FORMULA IS NOT RESPECTED" << std::endl;
+      *_output << "WARNING : EULER FORMULA IS NOT RESPECTED" << std::endl;
     }
     else
     {
-      std::cout << "done" << std::endl;
+      *_output << "done" << std::endl;
     }
   }
 
-  int	SmoothHullGeneratorVVR::getKey(int a, int b)
+  edgeKey	SmoothHullGeneratorVVR::getKey(int a, int b)
   {
-    return ((a<b)?(a*_points.size()+b):(b*_points.size()+a));
+    return undirectedKey(a, b);
   }
 
-  int	SmoothHullGeneratorVVR::getKey(turnData& td)
+  edgeKey	SmoothHullGeneratorVVR::getKey(turnData& td)
   {
-    return ((td._p1<td._p2)?(td._p1*_points.size()+td._p2):(td._p2*_points.size()+td._p1));
+    return undirectedKey(td._p1, td._p2);
+  }
+
+  int SmoothHullGeneratorVVR::hullEdges(std::vector<int>& faceEdges) const
+  {
+    //each edge is shared by two faces, the id is given by the first one
+    EdgeMap<int> ids;
+    ids.reserve(3*_spheres.size()/2);
+    faceEdges.resize(3*_spheres.size());
+    int nbEdges = 0;
+    for (unsigned int i=0; i<_spheres.size(); ++i)
+    {
+      const int v[3] = {_spheres[i]._point1, _spheres[i]._point2, _spheres[i]._point3};
+      for (int k=0; k<3; ++k)
+      {
+        int& id = ids[undirectedKey(v[k], v[(k+1)%3])];
+        if (id == 0)
+          id = ++nbEdges;
+        faceEdges[3*i+k] = id-1;
+      }
+    }
+    return nbEdges;
   }
 
 //
   double SmoothHullGeneratorVVR::getKeyByAngle(turnData& td)
   {
-    double aMin = 100.;
-    for (unsigned int j=0; j<_points.size(); ++j)
-    {
-      if (j!=td._p1 && j!=td._p2 && j!=td._p3)
+    return pivot(td)._key;
+  }
+
+  const SmoothHullGeneratorVVR::edgePivot& SmoothHullGeneratorVVR::pivot(turnData& td)
+  {
+    //the rotation only depends on the edge and on the sphere we come from, it is computed once
+    //for the priority of the edge and its processing, postponed or not
+    edgeKey e = directedKey(td._p1, td._p2);
+    const edgePivot* cached = _pivots.find(e);
+    if (cached && cached->_p3 == td._p3 &&
+        cached->_previousCenter.x == td._previousCenter.x &&
+        cached->_previousCenter.y == td._previousCenter.y &&
+        cached->_previousCenter.z == td._previousCenter.z)
+      return *cached;
+
+    edgePivot& ep = _pivots[e];
+    computePivot(td, ep, _workspace);
+    return ep;
+  }
+
+  void SmoothHullGeneratorVVR::exactCenter(const EdgeFrame<double>& frame, int j, pivotWorkspace& ws)
+  {
+    char valid;
+    _kernels->_edgeCenters(frame, &_x[j], &_y[j], &_z[j], 1, &ws._cx[j], &ws._cy[j], &ws._cz[j], &ws._pseudoAngle[j], &valid);
+    ws._state[j] = valid?exactSphere:noSphere;
+  }
+
+  bool SmoothHullGeneratorVVR::nextCandidates(pivotWorkspace& ws, const pivotCandidate& last, unsigned int k)
+  {
+    //the k smallest candidates greater than last, in a max-heap while scanning then in a min-heap.
+    //Returns true if there are no other ones
+    std::vector<pivotCandidate>& candidates = ws._candidates;
+    candidates.clear();
+    int n = ws._state.size();
+    bool complete = true;
+    for (int j=0; j<n; ++j)
+    {
+      if (ws._state[j] == noSphere)
+        continue;
+      if (candidates.size() == k && ws._key[j] > candidates.front()._pseudoAngle)
       {
-        vector3d c;
-        findCenter(td._p1, j, td._p2, c);
-        if (allPointsInSphere(c))
+        complete = false;
+        continue;
+      }
+      pivotCandidate pc = {ws._key[j], j};
+      if (!(last < pc))
+        continue;
+      if (candidates.size() < k)
+      {
+        candidates.push_back(pc);
+        std::push_heap(candidates.begin(), candidates.end());
+      }
+      else
+      {
+        complete = false;
+        if (pc < candidates.front())
+        {
+          std::pop_heap(candidates.begin(), candidates.end());
+          candidates.back() = pc;
+          std::push_heap(candidates.begin(), candidates.end());
+        }
+      }
+    }
+    std::make_heap(candidates.begin(), candidates.end(), std::greater<pivotCandidate>());
+    return complete;
+  }
+
+  void SmoothHullGeneratorVVR::computePivot(turnData& td, edgePivot& ep, pivotWorkspace& ws)
+  {
+    ep._p3 = td._p3;
+    ep._previousCenter = td._previousCenter;
+    ep._point = -1;
+    ep._angle = 0.;
+    ep._key = 100.;
+
+    /**
+     *The candidates are sorted by rotation angle around [td._p1,td._p2] in a heap, and the
+     *inclusion of all the points is only checked from the smallest angle until a sphere passes.
+     *A point found out of a sphere is a witness which is tested first on the following candidates.
+     *The inclusion tests are exact, with the symbolic perturbation of the points on the spheres :
+     *a single sphere contains all the points, the angles only give the order of the tests. The heap
+     *is ordered by a pseudo angle which avoids the acos, or by lower bounds of it given by the float
+     *kernel with mixed precision.
+     */
+    vector3d pointp1p2moy((_points[td._p1]+_points[td._p2])/2);
+    vector3d pointp1mp2(_points[td._p2]-_points[td._p1]);
+    bool noCenter = false;
+
+    //the terms of findCenter(td._p1, j, td._p2) and computeAngle that do not depend on j
+    EdgeFrame<double> frame;
+    frame._p1 = _points[td._p1];
+    frame._v = pointp1mp2;
+    frame._nv = pointp1mp2.normsquared();
+    frame._rho2 = (_R - _r) * (_R - _r);
+    frame._middle = pointp1p2moy;
+    frame._u = vector3d(pointp1p2moy, td._previousCenter);
+    frame._normU = frame._u.norm();
+
+    //each point has its slot, the candidates are then gathered in the same order whatever the number of threads
+    int n = _points.size();
+    ws._cx.resize(n);
+    ws._cy.resize(n);
+    ws._cz.resize(n);
+    ws._pseudoAngle.resize(n);
+    ws._key.resize(n);
+    ws._state.resize(n);
+    const int block = 1024;
+    if (_mixed)
+    {
+      EdgeFrame<float> frameFloat;
+      frameFloat._p1 = vector3f(_xf[td._p1], _yf[td._p1], _zf[td._p1]);
+      frameFloat._v = vector3f(_xf[td._p2], _yf[td._p2], _zf[td._p2]) - frameFloat._p1;
+      frameFloat._nv = frameFloat._v.normsquared();
+      frameFloat._rho2 = float(frame._rho2*_scale*_scale);
+      frameFloat._middle = (vector3f(_xf[td._p2], _yf[td._p2], _zf[td._p2]) + frameFloat._p1)/2.f;
+      vector3d previousCenter = (td._previousCenter-_origin)*_scale;
+      frameFloat._u = vector3f(float(previousCenter.x), float(previousCenter.y), float(previousCenter.z)) - frameFloat._middle;
+      frameFloat._normU = frameFloat._u.norm();
+      ws._halfTangent.resize(n);
+      ws._error.resize(n);
+#pragma omp parallel for schedule(static) num_threads(_threads) if(_threads > 1 && n >= parallelThreshold)
+      for (int b=0; b<n; b+=block)
+      {
+        _kernels->_halfTangentsFloat(frameFloat, &_xf[b], &_yf[b], &_zf[b], std::min(block, n-b),
+                                     &ws._halfTangent[b], &ws._error[b], &ws._state[b]);
+        for (int j=b; j<std::min(b+block, n); ++j)
         {
-          vector3d pointp1p2moy((_points[td._p1]+_points[td._p2])/2);
-          vector3d pointp1mp2(_points[td._p2]-_points[td._p1]);
-          double a = fabs(computeAngle(td._previousCenter,pointp1p2moy,c,pointp1mp2));
-          if (a<aMin)
-            aMin=a;
+          if (ws._state[j] == undecidedSphere)
+            exactCenter(frame, j, ws);
         }
       }
     }
-    return aMin;
+    else
+    {
+#pragma omp parallel for schedule(static) num_threads(_threads) if(_threads > 1 && n >= parallelThreshold)
+      for (int b=0; b<n; b+=block)
+      {
+        _kernels->_edgeCenters(frame, &_x[b], &_y[b], &_z[b], std::min(block, n-b),
+                               &ws._cx[b], &ws._cy[b], &ws._cz[b], &ws._pseudoAngle[b], &ws._state[b]);
+        for (int j=b; j<std::min(b+block, n); ++j)
+          ws._state[j] = ws._state[j]?exactSphere:noSphere;
+      }
+    }
+    for (int j=0; j<n; ++j)
+    {
+      if (j==td._p1 || j==td._p2 || j==td._p3)
+        ws._state[j] = noSphere;
+      else if (ws._state[j] == noSphere)
+        noCenter = true;
+      else if (ws._state[j] == exactSphere)
+        ws._key[j] = ws._pseudoAngle[j];
+      else
+        ws._key[j] = lowerPseudoAngle(ws._halfTangent[j], ws._error[j]);
+    }
+
+    //only the next candidates are kept in the heap, the following ones being greater than the last of them
+    std::vector<pivotCandidate>& candidates = ws._candidates;
+    pivotCandidate last = {-std::numeric_limits<double>::max(), -1};
+    bool complete = false;
+    int witness = -1;
+    candidates.clear();
+    while (ep._point < 0)
+    {
+      if (candidates.empty())
+      {
+        if (complete)
+          break;
+        complete = nextCandidates(ws, last, 16);
+        if (candidates.empty())
+          break;
+      }
+      last = candidates.front();
+      std::pop_heap(candidates.begin(), candidates.end(), std::greater<pivotCandidate>());
+      candidates.pop_back();
+      int j = last._point;
+      if (containsAll(td._p1, j, td._p2, witness))
+      {
+        ep._point = j;
+        findCenter(td._p1, j, td._p2, ep._center);
+        ep._angle = computeAngle(td._previousCenter,pointp1p2moy,ep._center,pointp1mp2);
+        ep._key = fabs(ep._angle);
+      }
+    }
+
+    //the priority of the edges has always been computed with a sphere centered on the origin
+    //for the vertices that do not give a sphere
+    if (noCenter)
+    {
+      vector3d c;
+      if (_tree.allWithin(c, (_R - _r) * (_R - _r)))
+        ep._key = std::min(ep._key, fabs(computeAngle(td._previousCenter,pointp1p2moy,c,pointp1mp2)));
+    }
+  }
+
+  void SmoothHullGeneratorVVR::pivotSuccessors(std::vector<turnData>& edges)
+  {
+    //the edges created by the faces that the rotations around the given edges lead to
+    std::vector<turnData> next;
+    for (unsigned int i=0; i<edges.size(); ++i)
+    {
+      turnData& td = edges[i];
+      int p = pivot(td)._point;
+      vector3d cs;
+      if (p < 0 || !findCenter(td._p1, p, td._p2, cs))
+        continue;
+      turnData td1 = {td._p1, p, td._p2, cs};
+      turnData td2 = {p, td._p2, td._p1, cs};
+      //an existing rotation is never overwritten, it may be the one of an edge of the front
+      if (!_pivots.contains(directedKey(td1._p1, td1._p2)))
+        next.push_back(td1);
+      if (!_pivots.contains(directedKey(td2._p1, td2._p2)))
+        next.push_back(td2);
+    }
+
+    //the rotations only depend on their turnData, they are computed independently
+    int m = next.size();
+    std::vector<edgePivot> pivots(m);
+    std::vector<pivotWorkspace> workspaces(_threads);
+#pragma omp parallel for schedule(dynamic) num_threads(_threads) if(_threads > 1 && m > 1)
+    for (int i=0; i<m; ++i)
+    {
+#ifdef _OPENMP
+      pivotWorkspace& ws = workspaces[omp_get_thread_num()];
+#else
+      pivotWorkspace& ws = workspaces[0];
+#endif
+      computePivot(next[i], pivots[i], ws);
+    }
+    for (int i=0; i<m; ++i)
+      _pivots.insert(directedKey(next[i]._p1, next[i]._p2), pivots[i]);
   }
 
   void SmoothHullGeneratorVVR::travelCover(VVRSFace s)
   {
-    std::set<int> edgeStack;
-    std::multimap<double,turnData> edgeStackByAngle;
-    std::set<int> computedEdge;
+    EdgeFront<turnData> front;		//edges to turn around, by angle
+    EdgeSet computedEdge;
+    EdgeSet speculated;				//edges whose successors were pivoted ahead
+    std::vector<turnData> batch;
+    _pivots.clear();
     turnData td = {s._point1,s._point2,s._point3,s._center};
-    edgeStack.insert(getKey(td));
-    edgeStackByAngle.insert(std::pair<double,turnData>(getKeyByAngle(td),td));
+    front.push(getKey(td), getKeyByAngle(td), td);
     td._p1 = s._point2;
     td._p2 = s._point3;
     td._p3 = s._point1;
-    edgeStack.insert(getKey(td));
-    edgeStackByAngle.insert(std::pair<double,turnData>(getKeyByAngle(td),td));
+    front.push(getKey(td), getKeyByAngle(td), td);
     td._p1 = s._point3;
     td._p2 = s._point1;
     td._p3 = s._point2;
-    edgeStack.insert(getKey(td));
-    edgeStackByAngle.insert(std::pair<double,turnData>(getKeyByAngle(td),td));
+    front.push(getKey(td), getKeyByAngle(td), td);
 
     _spheres.push_back(s);
     _index.insert(s._point1);
@@ -349,120 +959,66 @@ namespace SCD
     _index.insert(s._point3);
 
 #ifdef DISPLAY_INFO
-    std::cout.precision(17);
-    std::cout << "Original triangle : " << s._point1 << " " << s._point2 << " " << s._point3 << std::endl;
-    std::cout << "Center " << s._center << std::endl;
-    std::cout << _points[s._point1] << std::endl;
-    std::cout << _points[s._point2] << std::endl;
-    std::cout << _points[s._point3] << std::endl;
-    for (std::multimap<double, turnData>::iterator ei=edgeStackByAngle.begin(); ei!=edgeStackByAngle.end(); ++ei)
-      std::cout << "Edge [" << (ei->second)._p1 << "," << (ei->second)._p2 << "] angle " << ei->first << std::endl;
+    _output->precision(17);
+    *_output << "Original triangle : " << s._point1 << " " << s._point2 << " " << s._point3 << std::endl;
+    *_output << "Center " << s._center << std::endl;
+    *_output << _points[s._point1] << std::endl;
+    *_output << _points[s._point2] << std::endl;
+    *_output << _points[s._point3] << std::endl;
+    *_output << "Edges in the front " << front.size() << std::endl;
 #endif
+#ifdef DISPLAY_INFO
     double curr_edge_angle;
+#endif
 
-    while (!edgeStackByAngle.empty())
+    while (!front.empty())
     {
-postponed:
-      td = (edgeStackByAngle.begin())->second;
-      //#ifdef DISPLAY_INFO
-      curr_edge_angle = (edgeStackByAngle.begin())->first;
-      //#endif
-      edgeStack.erase(getKey(td));
-      edgeStackByAngle.erase(edgeStackByAngle.begin());
+      if (_speculation > 0 && !speculated.contains(getKey(front.top()._p1, front.top()._p2)))
+      {
+        //pivot ahead the successors of the next edges, the serial processing below then finds them
+        //in the cache, or computes them again if the front has changed in between
+        front.best(_speculation, batch);
+        unsigned int k = 0;
+        for (unsigned int i=0; i<batch.size(); ++i)
+        {
+          if (speculated.insert(getKey(batch[i])))
+            batch[k++] = batch[i];
+        }
+        batch.resize(k);
+        pivotSuccessors(batch);
+      }
+      td = front.top();
+#ifdef DISPLAY_INFO
+      curr_edge_angle = front.topPriority();
+#endif
+      front.pop();
 
-      if (!((computedEdge.insert(getKey(td))).second))
+      if (!computedEdge.insert(getKey(td)))
       {
-        std::cout << "WARNING, edge already processed : "<< td._p1 << ", " << td._p2 << std::endl;
+        *_output << "WARNING, edge already processed : "<< td._p1 << ", " << td._p2 << std::endl;
         continue;
       }
 
 
 
-      std::multimap<double, int> sortedPoints;
-      vector3d c;
-      unsigned int j_min = 0;
-      double distInSphereMin = 100000.;
-      for (unsigned int j=0; j<_points.size(); ++j)
+      const edgePivot& ep = pivot(td);
+      int p = ep._point;
+      if (p < 0)
       {
-        if (j!=td._p1 && j!=td._p2 && j!=td._p3)
-        {
-          if (findCenter(td._p1, j, td._p2, c))
-          {
-            double err_max = distMaxPointsInSphere(c);
-            if (err_max<distInSphereMin)
-            {
-              distInSphereMin = err_max;
-              j_min = j;
-            }
-#ifdef DISPLAY_INFO
-            std::cout << "err points in sphere " << j << " " << err_max << std::endl;
-#endif
-            if (allPointsInSphere(c))
-            {
-              vector3d pointp1p2moy((_points[td._p1]+_points[td._p2])/2);
-              vector3d pointp1mp2(_points[td._p2]-_points[td._p1]);
-              double a = computeAngle(td._previousCenter,pointp1p2moy,c,pointp1mp2);
-              sortedPoints.insert(std::pair<double, int>(a,j));
-            }
-          }
-        }
-      }
-      if (sortedPoints.empty())
-      {
-        std::cout << "WARNING, no new vertex found in rotation around edge [" << td._p1 << ", " << td._p2 << "] that satisfy inclusion in shpere of all other vertices with chosen precision" << std::endl;
-        std::cout << "Taking vertex that satisfy best this condition with value " << distInSphereMin << std::endl;
-        if (!findCenter(td._p1, j_min, td._p2, c))
-          std::cout << "ERROR, choosen new vertex does not allow to build a shpere with edge" << std::endl;
-        vector3d pointp1p2moy((_points[td._p1]+_points[td._p2])/2);
-        vector3d pointp1mp2(_points[td._p2]-_points[td._p1]);
-        double a = computeAngle(td._previousCenter,pointp1p2moy,c,pointp1mp2);
-        sortedPoints.insert(std::pair<double, int>(a,j_min));
+        *_output << "ERROR, no sphere of radius R-r through the edge [" << td._p1 << ", " << td._p2 << "] contains all the points, the edge stays open" << std::endl;
+        continue;
       }
-      if (!sortedPoints.empty())
       {
-        int p = sortedPoints.begin()->second;
 #ifdef DISPLAY_INFO
-        std::cout << "nb candidate vertices " << sortedPoints.size() << " around edge [" << td._p1 << ", " << td._p2 << "] ";
-        for (std::multimap<double, int>::iterator pi=sortedPoints.begin(); pi!=sortedPoints.end(); ++pi)
-        {
-          std::cout << " " << pi->first << " " << pi->second << " " << (_index.find(pi->second)!=_index.end()); //->first;
-          if (pi->second>1.)
-          {
-            std::cout << " computed_edge_angle " << curr_edge_angle << " next " <<  (edgeStackByAngle.begin())->first; //->first;
-          }
-        }
-        std::cout << std::endl;
+        *_output << "vertex " << p << " (angle " << ep._angle << ") chosen around edge [" << td._p1 << ", " << td._p2 << "] ";
+        *_output << " computed_edge_angle " << curr_edge_angle << std::endl;
         // see if none of the possible new edges already computed
-        if (computedEdge.find(getKey(p,td._p1))!=computedEdge.end())
-          std::cout << "EDGE with " << p << " and " << td._p1 << " already added" << std::endl;
-        if (computedEdge.find(getKey(p,td._p2))!=computedEdge.end())
-          std::cout << "EDGE with " << p << " and " << td._p2 << " already added" << std::endl;
+        if (computedEdge.contains(getKey(p,td._p1)))
+          *_output << "EDGE with " << p << " and " << td._p1 << " already added" << std::endl;
+        if (computedEdge.contains(getKey(p,td._p2)))
+          *_output << "EDGE with " << p << " and " << td._p2 << " already added" << std::endl;
 #endif
-        if (sortedPoints.size()>1)
-        {
-#ifdef DISPLAY_INFO
-          std::cout << td._p1 << " " << _points[td._p1] << std::endl << td._p2 << " " << _points[td._p2] << std::endl;
-          for (std::multimap<double, int>::iterator pi=sortedPoints.begin(); pi!=sortedPoints.end(); ++pi)
-            std::cout << pi->second << " " << _points[pi->second] << std::endl; //->first;
-#endif
-          // if there is indeterminacy between candidate, postpone choice by increasing angle
-          if (curr_edge_angle<3.14159)
-          {
-            computedEdge.erase(getKey(td));
-            edgeStack.insert(getKey(td));
-            edgeStackByAngle.insert(std::pair<double,turnData>(getKeyByAngle(td)+3.14159,td));
-#ifdef DISPLAY_INFO
-            std::cout << "POSTPONING decision" << std::endl;
-#endif
-            goto postponed;
-#ifdef DISPLAY_INFO
-          }
-          else
-          {
-            std::cout << "treating POSTPONED edge" << std::endl;
-#endif
-          }
-        }
+        _pivots.erase(directedKey(td._p1, td._p2));
         vector3d cs;
         findCenter(td._p1, p, td._p2, cs);
         VVRSFace sp = {td._p1, p, td._p2,cs};
@@ -474,163 +1030,505 @@ postponed:
         turnData td2 = {p, td._p2,td._p1,cs};
 
 
-        if (!(edgeStack.insert(getKey(td1)).second))
+        if (const turnData* closed = front.find(getKey(td1)))
         {
-          std::multimap<double,turnData>::iterator it = edgeStackByAngle.begin();
 #ifdef DISPLAY_INFO
-          std::cout << "erasing edge "<< td1._p1 << " " << td1._p2 << " completely processed" << std::endl;
+          *_output << "erasing edge "<< td1._p1 << " " << td1._p2 << " completely processed" << std::endl;
 #endif
-          while (getKey(it->second) != getKey(td1))
-            ++it;
-          edgeStackByAngle.erase(it);
-          edgeStack.erase(getKey(td1));
+          _pivots.erase(directedKey(closed->_p1, closed->_p2));
+          front.erase(getKey(td1));
         }
         else
         {
-          edgeStackByAngle.insert(std::pair<double,turnData>(getKeyByAngle(td1),td1));
+          front.push(getKey(td1), getKeyByAngle(td1), td1);
         }
 
-        if (!(edgeStack.insert(getKey(td2)).second))
+        if (const turnData* closed = front.find(getKey(td2)))
         {
-          std::multimap<double,turnData>::iterator it = edgeStackByAngle.begin();
 #ifdef DISPLAY_INFO
-          std::cout << "erasing edge "<< td2._p1 << " " << td2._p2 << " completely processed" << std::endl;
+          *_output << "erasing edge "<< td2._p1 << " " << td2._p2 << " completely processed" << std::endl;
 #endif
-          while (getKey(it->second) != getKey(td2))
-            ++it;
-          edgeStackByAngle.erase(it);
-          edgeStack.erase(getKey(td2));
+          _pivots.erase(directedKey(closed->_p1, closed->_p2));
+          front.erase(getKey(td2));
         }
         else
         {
-          edgeStackByAngle.insert(std::pair<double,turnData>(getKeyByAngle(td2),td2));
+          front.push(getKey(td2), getKeyByAngle(td2), td2);
         }
 
       }
-      else
+    }
+
+#ifdef DISPLAY_INFO
+    for (int i=0; i<_spheres.size(); ++i)
+    {
+      *_output << _spheres[i]._point1 << " " << _spheres[i]._point2 << " " << _spheres[i]._point3 << std::endl;
+    }
+    for (unsigned int j=0; j<_points.size(); ++j)
+    {
+      *_output << j << " " << _points[j].x << " " << _points[j].y << " " << _points[j].z << std::endl;
+    }
+#endif
+  }
+
+//#ifdef FALSE
+  void SmoothHullGeneratorVVR::printSphere(VVRSFace& s)
+  {
+    *_output << "**Spheres**" << std::endl;
+    *_output<< "   center : " << s._center.x << ", " << s._center.y << ", " << s._center.z << std::endl;
+    *_output<< "   point1 [" << s._point1 << "] : " << _points[s._point1].x << ", " << _points[s._point1].y << ", " << _points[s._point1].z << std::endl;
+    *_output<< "   point2 [" << s._point2 << "] : " << _points[s._point2].x << ", " << _points[s._point2].y << ", " << _points[s._point2].z << std::endl;
+    *_output<< "   point3 [" << s._point3 << "] : " << _points[s._point3].x << ", " << _points[s._point3].y << ", " << _points[s._point3].z << std::endl;
+  }
+
+  bool SmoothHullGeneratorVVR::readVertex(const std::string& filename)
+  {
+    *_output << "reading " << filename << "..... ";
+    if (!readPoints(_points, filename, _threads, *_output))
+      return false;
+    //the vertices of a mesh are repeated in its faces
+    if (pointFileFormat(filename) != CLOUD_FILE)
+    {
+      unsigned int n = _points.size();
+      unsigned int nbMerged = weldPoints(0.);
+      *_output << n << " vertices, " << nbMerged << " duplicates merged" << std::endl;
+    }
+    return true;
+  }
+
+  void SmoothHullGeneratorVVR::output(const std::string& rootPath)
+  {
+    //we first build a map to change the index of points in the spheres, according to the vertex that have been kept
+    std::vector<int> map;
+
+    *_output << "please enter the name of the output file" << std::endl;
+    std::string s;
+    std::cin >> s;
+    std::string name = rootPath + s;
+
+    std::ofstream output;
+    output.open(name.c_str(),std::ofstream::out);
+    if (output.is_open())
+    {
+      int k=0;
+      output << _r << "," << _R << "\n";
+      output << _index.size() << "," << _spheres.size() << "\n";
+      for (unsigned int i=0; !_index.empty(); ++i)
       {
-        std::cout << "No sphere were found while turning around [" << td._p1 << ", " << td._p2 << "]" << std::endl;
+        if (*(_index.begin()) == i)
+        {
+          output << "[" << _points[*(_index.begin())].x << ","
+                 << _points[*(_index.begin())].y << ","
+                 << _points[*(_index.begin())].z << "],";
+          map.push_back(k);
+          _index.erase(_index.begin());
+          k++;
+        }
+        else
+        {
+          map.push_back(-1);
+        }
+      }
+      output << std::endl;
+      for (unsigned int i=0; i<_spheres.size(); ++i)
+      {
+        output << "[" << (map[_spheres[i]._point1]+1) << "," << (map[_spheres[i]._point2]+1) << "," << (map[_spheres[i]._point3]+1) << "],";
+      }
+      output.close();
+    }
+  }
+//#endif
+
+  unsigned int SmoothHullGeneratorVVR::weldPoints(double tolerance)
+  {
+    unsigned int n = _points.size();
+    if (n == 0)
+      return 0;
+    vector3d pmin, pmax;
+    boundingBox(_points, pmin, pmax);
+
+    //the kept points are put in the grid : a point is merged if one of them is in the neighbouring cells
+    PointGrid grid(pmin, pmax, tolerance);
+    double tol2 = tolerance*tolerance;
+    std::vector<vector3d> kept;
+    kept.reserve(n);
+    for (unsigned int i=0; i<n; ++i)
+    {
+      const vector3d& p = _points[i];
+      bool merged = false;
+      for (int dx=-1; dx<=1 && !merged; ++dx)
+      {
+        for (int dy=-1; dy<=1 && !merged; ++dy)
+        {
+          for (int dz=-1; dz<=1 && !merged; ++dz)
+          {
+            for (int k=grid.first(grid.cell(p, dx, dy, dz)); k>=0 && !merged; k=grid.next(k))
+              merged = ((kept[k]-p).normsquared() <= tol2);
+          }
+        }
+      }
+      if (!merged)
+      {
+        grid.insert(p, kept.size());
+        kept.push_back(p);
+      }
+    }
+
+    unsigned int nbMerged = n-kept.size();
+    _points.swap(kept);
+    return nbMerged;
+  }
+
+  namespace
+  {
+    //indices, in increasing order, of the points kept by the clustering of the cloud in cells of the given
+    //size : the farthest one from the center of the cloud in each cell, the lowest index in case of equality
+    void clusterPoints(const std::vector<vector3d>& points, const vector3d& pmin, const vector3d& pmax,
+                       double cellSize, std::vector<int>& kept)
+    {
+      vector3d center = (pmin+pmax)*0.5;
+      PointGrid grid(pmin, pmax, cellSize);
+      EdgeMap<int> representative;
+      representative.reserve(points.size());
+      for (unsigned int i=0; i<points.size(); ++i)
+      {
+        edgeKey c = grid.cell(points[i]);
+        int* r = representative.find(c);
+        if (!r)
+          representative.insert(c, i);
+        else if ((points[i]-center).normsquared() > (points[*r]-center).normsquared())
+          *r = i;
+      }
+      kept.clear();
+      for (unsigned int i=0; i<points.size(); ++i)
+      {
+        if (*representative.find(grid.cell(points[i])) == int(i))
+          kept.push_back(i);
+      }
+    }
+
+    //largest distance from a point of the cloud to the kept ones, knowing that it is smaller than maxDist
+    double clusteringError(const std::vector<vector3d>& points, const vector3d& pmin, const vector3d& pmax,
+                           const std::vector<int>& kept, double maxDist)
+    {
+      PointGrid grid(pmin, pmax, maxDist);
+      std::vector<bool> isKept(points.size(), false);
+      for (unsigned int i=0; i<kept.size(); ++i)
+      {
+        grid.insert(points[kept[i]], kept[i]);
+        isKept[kept[i]] = true;
+      }
+      double error2 = 0.;
+      for (unsigned int i=0; i<points.size(); ++i)
+      {
+        if (isKept[i])
+          continue;
+        double dist2 = maxDist*maxDist;
+        for (int dx=-1; dx<=1; ++dx)
+        {
+          for (int dy=-1; dy<=1; ++dy)
+          {
+            for (int dz=-1; dz<=1; ++dz)
+            {
+              for (int k=grid.first(grid.cell(points[i], dx, dy, dz)); k>=0; k=grid.next(k))
+                dist2 = std::min(dist2, (points[k]-points[i]).normsquared());
+            }
+          }
+        }
+        error2 = std::max(error2, dist2);
       }
+      return sqrt(error2);
     }
+  }
 
-#ifdef DISPLAY_INFO
-    for (int i=0; i<_spheres.size(); ++i)
-    {
-      std::cout << _spheres[i]._point1 << " " << _spheres[i]._point2 << " " << _spheres[i]._point3 << std::endl;
+  double SmoothHullGeneratorVVR::decimatePoints(double tolerance, unsigned int count)
+  {
+    //the points strictly inside the convex hull are inside the STP-BV of the others, they are removed at no cost
+    std::vector<int> hullIndex;
+    ConvexHull hull(_points);
+    if (hull.compute())
+    {
+      hull.boundaryPoints(hullIndex);
+      std::vector<vector3d> cloud(hullIndex.size());
+      for (unsigned int i=0; i<hullIndex.size(); ++i)
+        cloud[i] = _points[hullIndex[i]];
+      _points.swap(cloud);
+    }
+    if (_points.empty() || (tolerance <= 0. && (count == 0 || _points.size() <= count)))
+      return 0.;
+
+    vector3d pmin, pmax;
+    boundingBox(_points, pmin, pmax);
+    std::vector<int> kept;
+    double cellSize;
+    if (count > 0)
+    {
+      //smallest cell size keeping at most count points, by bisection between a size keeping them all and one
+      //that gathers the cloud in a single cell
+      double lo = 0.;
+      double hi = 2*std::max(pmax.x-pmin.x, std::max(pmax.y-pmin.y, pmax.z-pmin.z));
+      std::vector<int> candidate;
+      clusterPoints(_points, pmin, pmax, hi, kept);
+      for (int iter=0; iter<50 && hi-lo > 1e-6*hi; ++iter)
+      {
+        double mid = 0.5*(lo+hi);
+        clusterPoints(_points, pmin, pmax, mid, candidate);
+        if (candidate.size() <= count)
+        {
+          hi = mid;
+          kept.swap(candidate);
+        }
+        else
+          lo = mid;
+      }
+      cellSize = hi;
     }
-    for (unsigned int j=0; j<_points.size(); ++j)
+    else
     {
-      std::cout << j << " " << _points[j].x << " " << _points[j].y << " " << _points[j].z << std::endl;
+      //a point is at most at the diagonal of its cell from the representative of the cell
+      cellSize = tolerance/sqrt(3.);
+      clusterPoints(_points, pmin, pmax, cellSize, kept);
     }
-#endif
-  }
 
-//#ifdef FALSE
-  void SmoothHullGeneratorVVR::printSphere(VVRSFace& s)
-  {
-    std::cout << "**Spheres**" << std::endl;
-    std::cout<< "   center : " << s._center.x << ", " << s._center.y << ", " << s._center.z << std::endl;
-    std::cout<< "   point1 [" << s._point1 << "] : " << _points[s._point1].x << ", " << _points[s._point1].y << ", " << _points[s._point1].z << std::endl;
-    std::cout<< "   point2 [" << s._point2 << "] : " << _points[s._point2].x << ", " << _points[s._point2].y << ", " << _points[s._point2].z << std::endl;
-    std::cout<< "   point3 [" << s._point3 << "] : " << _points[s._point3].x << ", " << _points[s._point3].y << ", " << _points[s._point3].z << std::endl;
+    double error = clusteringError(_points, pmin, pmax, kept, PointGrid(pmin, pmax, cellSize).cellSize()*sqrt(3.));
+    std::vector<vector3d> cloud(kept.size());
+    for (unsigned int i=0; i<kept.size(); ++i)
+      cloud[i] = _points[kept[i]];
+    _points.swap(cloud);
+    return error;
   }
 
-  void SmoothHullGeneratorVVR::readVertex(const std::string& filename)
+  bool SmoothHullGeneratorVVR::loadGeometry(const std::string& filename)
   {
-    FILE * file;
-    // Open file
-    file = fopen(filename.c_str(), "r");
-    if (file == 0)
+    if (!readVertex(filename))
+      return false;
+    if (_weld >= 0.)
     {
-      std::cout << "unable to open file " << filename << std::endl;
-      return;
+      unsigned int nbMerged = weldPoints(_weld);
+      *_output << "welding..... " << nbMerged << " points merged, " << _points.size() << " left" << std::endl;
     }
-
-    std::cout << "reading " << filename << "..... ";
-    int nbPtsPerFace;
-    if(fscanf(file, "%d\n", &nbPtsPerFace) != 1)
+    if (_decimationTolerance > 0. || _decimationCount > 0)
     {
-      std::cout << filename << " is in the wrong file format." << std::endl;
-      return;
+      unsigned int n = _points.size();
+      double error = decimatePoints(_decimationTolerance, _decimationCount);
+      *_output << "decimation..... " << _points.size() << "/" << n << " points kept, outward error " << error
+                << " : with r = " << _r + error << " the STP-BV contains the one of the whole cloud" << std::endl;
     }
+    return true;
+  }
+  bool SmoothHullGeneratorVVR::insertGeometry(const std::string& filename)
+  {
+    std::vector<vector3d> points;
+    _points.swap(points);
+    bool read = readVertex(filename);
+    _points.swap(points);
+    if (read)
+      insertPoints(points);
+    return read;
+  }
 
-    int nVert;
-    double x,y,z;
-    _points.clear();
-    if(fscanf(file, "%d\n", &nVert) != 1)
+  void SmoothHullGeneratorVVR::insertPoints(const std::vector<vector3d>& points)
+  {
+    unsigned int n0 = _points.size();
+    _points.insert(_points.end(), points.begin(), points.end());
+    if (_spheres.empty())
     {
-      std::cout << filename << " is in the wrong file format." << std::endl;
-      fclose (file);
+      _index.clear();
+      cover();
       return;
     }
 
-    vector3d v;
-    for (int i=0; i<nVert; ++i)
-    {
-      if(fscanf(file, "%lf %lf %lf\n", &x, &y, &z) != 3)
+    /**
+     *A face of the new STP-BV whose vertices are old points is a face of the old one, the new faces
+     *are thus the ones joining the new point to the border of the region of the faces whose spheres
+     *exclude it : the rotation around each edge of this border stops at the new point. As in the
+     *randomized incremental construction of the convex hull, each point still to insert keeps the list
+     *of the faces it is in conflict with, and the lists of a new face are taken among the points of the
+     *two faces on both sides of its border edge. The new faces are checked with the exact predicates
+     *against their neighbours, and the whole STP-BV is computed again if the update is not local.
+     */
+    unsigned int nbFaces = _spheres.size();
+    std::vector<bool> alive(nbFaces, true);
+    EdgeMap<int> faceOf;						//face of each oriented edge
+    faceOf.reserve(3*nbFaces);
+    for (unsigned int f=0; f<nbFaces; ++f)
+    {
+      const int v[3] = {_spheres[f]._point1, _spheres[f]._point2, _spheres[f]._point3};
+      for (int e=0; e<3; ++e)
+        faceOf.insert(directedKey(v[e], v[(e+1)%3]), f);
+    }
+    unsigned int m = points.size();
+    std::vector<std::vector<int> > pointConflicts(m);	//faces of each point to insert
+    std::vector<std::vector<int> > faceConflicts(nbFaces);	//points to insert of each face
+    for (unsigned int f=0; f<nbFaces; ++f)
+    {
+      //the points closer to the approximate center than rho-error are inside, as in containsAll
+      const VVRSFace& s = _spheres[f];
+      vector3d c;
+      double error;
+      _predicates.center(s._point1, s._point2, s._point3, c, error);
+      double in2 = (error < _R-_r)?(_R-_r-error)*(_R-_r-error)*(1-1e-14):0.;
+      for (unsigned int k=0; k<m; ++k)
       {
-        std::cout << filename << " is in the wrong file format." << std::endl;
-        fclose (file);
-        return;
+        if ((points[k]-c).normsquared() > in2 && _predicates.side(s._point1, s._point2, s._point3, n0+k) > 0)
+        {
+          pointConflicts[k].push_back(f);
+          faceConflicts[f].push_back(k);
+        }
       }
-
-      v.x = double(x);
-      v.y = double(y);
-      v.z = double(z);
-      _points.push_back(v);
     }
 
-    // Close file
-    fclose (file);
-  }
-
-  void SmoothHullGeneratorVVR::output(const std::string& rootPath)
-  {
-    //we first build a map to change the index of points in the spheres, according to the vertex that have been kept
-    std::vector<int> map;
+    std::vector<int> mark(nbFaces, -1);
+    std::vector<int> pointMark(m, -1);
+    unsigned int nbInserted = 0;
+    bool local = true;
+    for (unsigned int k=0; k<m && local; ++k)
+    {
+      int p = n0+k;
+      std::vector<int> region;
+      for (unsigned int i=0; i<pointConflicts[k].size(); ++i)
+      {
+        int f = pointConflicts[k][i];
+        if (alive[f] && mark[f] != p)
+        {
+          mark[f] = p;
+          region.push_back(f);
+        }
+      }
+      if (region.empty())
+        continue;
 
-    std::cout << "please enter the name of the output file" << std::endl;
-    std::string s;
-    std::cin >> s;
-    std::string name = rootPath + s;
+      //the border of the region must be a single cycle
+      std::vector<borderEdge> border;
+      std::map<int, int> nextEdge;				//border edge starting at each vertex
+      for (unsigned int i=0; i<region.size() && local; ++i)
+      {
+        const VVRSFace& s = _spheres[region[i]];
+        const int v[3] = {s._point1, s._point2, s._point3};
+        for (int e=0; e<3 && local; ++e)
+        {
+          const int* g = faceOf.find(directedKey(v[(e+1)%3], v[e]));
+          if (g == 0)
+            local = false;
+          else if (mark[*g] != p)
+          {
+            borderEdge b = {v[e], v[(e+1)%3], region[i], *g};
+            local = nextEdge.insert(std::make_pair(b._p1, int(border.size()))).second;
+            border.push_back(b);
+          }
+        }
+      }
+      unsigned int length = 0;
+      for (int b=0; local && length<border.size(); )
+      {
+        std::map<int, int>::iterator it = nextEdge.find(border[b]._p2);
+        local = (it != nextEdge.end());
+        ++length;
+        if (local && (b = it->second) == 0)
+          break;
+      }
+      local = local && length == border.size() && length >= 3;
 
-    std::ofstream output;
-    output.open(name.c_str(),std::ofstream::out);
-    if (output.is_open())
-    {
-      int k=0;
-      output << _r << "," << _R << "\n";
-      output << _index.size() << "," << _spheres.size() << "\n";
-      for (unsigned int i=0; !_index.empty(); ++i)
+      //the new faces [p1,p2,p] and their spheres, which must contain the vertices around them
+      std::vector<VVRSFace> faces(border.size());
+      for (unsigned int b=0; b<border.size() && local; ++b)
       {
-        if (*(_index.begin()) == i)
+        const borderEdge& be = border[b];
+        VVRSFace s = {be._p1, be._p2, p, vector3d()};
+        vector3d c;
+        double error;
+        local = _predicates.center(be._p1, be._p2, p, c, error) && findCenter(be._p1, be._p2, p, s._center);
+        faces[b] = s;
+        const VVRSFace& outer = _spheres[be._outer];
+        int w = outer._point1+outer._point2+outer._point3-be._p1-be._p2;
+        int x = border[nextEdge[be._p2]]._p2;
+        local = local && _predicates.side(be._p1, be._p2, p, w) < 0 && _predicates.side(be._p1, be._p2, p, x) < 0;
+        for (unsigned int i=0; i<region.size() && local; ++i)
         {
-          output << "[" << _points[*(_index.begin())].x << ","
-                 << _points[*(_index.begin())].y << ","
-                 << _points[*(_index.begin())].z << "],";
-          map.push_back(k);
-          _index.erase(_index.begin());
-          k++;
+          const int v[3] = {_spheres[region[i]]._point1, _spheres[region[i]]._point2, _spheres[region[i]]._point3};
+          for (int e=0; e<3 && local; ++e)
+          {
+            if (v[e] != be._p1 && v[e] != be._p2)
+              local = _predicates.side(be._p1, be._p2, p, v[e]) < 0;
+          }
         }
-        else
+      }
+      if (!local)
+      {
+        *_output << "WARNING, the insertion of the point " << p << " is not local, the STP-BV is computed again" << std::endl;
+        break;
+      }
+
+      //the vertices of the region that are not on its border are now inside
+      std::set<int> borderVertices;
+      for (unsigned int b=0; b<border.size(); ++b)
+        borderVertices.insert(border[b]._p1);
+      for (unsigned int i=0; i<region.size(); ++i)
+      {
+        int f = region[i];
+        alive[f] = false;
+        const int v[3] = {_spheres[f]._point1, _spheres[f]._point2, _spheres[f]._point3};
+        for (int e=0; e<3; ++e)
         {
-          map.push_back(-1);
+          faceOf.erase(directedKey(v[e], v[(e+1)%3]));
+          if (borderVertices.count(v[e]) == 0)
+            _index.erase(v[e]);
         }
       }
-      output << std::endl;
-      for (unsigned int i=0; i<_spheres.size(); ++i)
+      _index.insert(p);
+      for (unsigned int b=0; b<border.size(); ++b)
       {
-        output << "[" << (map[_spheres[i]._point1]+1) << "," << (map[_spheres[i]._point2]+1) << "," << (map[_spheres[i]._point3]+1) << "],";
+        int f = _spheres.size();
+        _spheres.push_back(faces[b]);
+        alive.push_back(true);
+        mark.push_back(-1);
+        faceConflicts.push_back(std::vector<int>());
+        faceOf.insert(directedKey(faces[b]._point1, faces[b]._point2), f);
+        faceOf.insert(directedKey(faces[b]._point2, faces[b]._point3), f);
+        faceOf.insert(directedKey(faces[b]._point3, faces[b]._point1), f);
+
+        const int sides[2] = {border[b]._inner, border[b]._outer};
+        for (int t=0; t<2; ++t)
+        {
+          const std::vector<int>& candidates = faceConflicts[sides[t]];
+          for (unsigned int i=0; i<candidates.size(); ++i)
+          {
+            int q = candidates[i];
+            if (q <= int(k) || pointMark[q] == f)
+              continue;
+            pointMark[q] = f;
+            if (_predicates.side(faces[b]._point1, faces[b]._point2, p, n0+q) > 0)
+            {
+              pointConflicts[q].push_back(f);
+              faceConflicts[f].push_back(q);
+            }
+          }
+        }
       }
-      output.close();
+      for (unsigned int i=0; i<region.size(); ++i)
+        std::vector<int>().swap(faceConflicts[region[i]]);
+      ++nbInserted;
     }
-  }
-//#endif
 
-  void SmoothHullGeneratorVVR::loadGeometry(const std::string& filename)
-  {
-    readVertex(filename);
+    if (!local)
+    {
+      _index.clear();
+      _spheres.clear();
+      cover();
+      return;
+    }
+    unsigned int f = 0;
+    for (unsigned int i=0; i<_spheres.size(); ++i)
+    {
+      if (alive[i])
+        _spheres[f++] = _spheres[i];
+    }
+    _spheres.resize(f);
+    *_output << "insertion..... " << nbInserted << "/" << m << " points changed the STP-BV, " << _spheres.size() << " faces" << std::endl;
+    if (_spheres.size() != ((_index.size()-2)*2))
+      *_output << "WARNING : EULER FORMULA IS NOT RESPECTED" << std::endl;
   }
+
 //#ifdef FALSE
 
   void SmoothHullGeneratorVVR::compute3DSMaxHull(const std::string& rootPath)
@@ -661,7 +1559,7 @@ postponed:
     int k=0;
     std::vector<int> map;
 
-    std::cout << "size of _index : " << _index.size() << std::endl;
+    *_output << "size of _index : " << _index.size() << std::endl;
     for (unsigned int i=0; !_index.empty(); ++i)
     {
       if (*(_index.begin()) == i)
@@ -694,14 +1592,68 @@ postponed:
 //#endif
   void SmoothHullGeneratorVVR::computeVVR_Prime(const std::string& filename)
   {
-    std::ofstream os;
+    //computing hull
+    STPBV stpbv;
+    computeVVR_Prime(stpbv);
+    writeSTPBV(stpbv, filename, _format, *_output);
+  }
+
+  void SmoothHullGeneratorVVR::computeVVR_Prime(const std::vector<std::pair<double, double> >& radii,
+                                                const std::vector<std::string>& filenames)
+  {
+    //by decreasing R-r, each STP-BV starting from the vertices of the previous one
+    std::vector<std::pair<double, int> > order;
+    for (unsigned int i=0; i<radii.size(); ++i)
+      order.push_back(std::make_pair(-(radii[i].second-radii[i].first), int(i)));
+    std::stable_sort(order.begin(), order.end());
+    for (unsigned int i=0; i<order.size(); ++i)
+    {
+      const std::pair<double, double>& rR = radii[order[i].second];
+      *_output << "\n STP-BV parameters: r = " << rR.first << ", R = " << rR.second << std::endl;
+      setRadii(rR.first, rR.second);
+      if (_spheres.empty())
+        cover();
+      outputVVR_Prime(filenames[order[i].second]);
+    }
+  }
+
+  void SmoothHullGeneratorVVR::outputVVR_Prime(const std::string& filename)
+  {
+    STPBV stpbv;
+    buildVVR_Prime(stpbv);
+    writeSTPBV(stpbv, filename, _format, *_output);
+  }
+
+  void SmoothHullGeneratorVVR::computeVVR_Prime(STPBV& stpbv)
+  {
+    _index.clear();
+    _spheres.clear();
+    std::string key;
+    if (!_cacheDirectory.empty())
+    {
+      STPBVCache cache(_cacheDirectory, _cacheSize, *_output);
+      key = STPBVCache::key(_points, _r, _R, _hullFilter);
+      if (cache.load(key, stpbv) && stpbv._r == _r && stpbv._R == _R)
+      {
+        *_output << "cache..... STP-BV " << key << " read from " << _cacheDirectory << std::endl;
+        return;
+      }
+    }
+    cover();
+    buildVVR_Prime(stpbv);
+    if (!_cacheDirectory.empty() && STPBVCache(_cacheDirectory, _cacheSize, *_output).store(key, stpbv))
+      *_output << "cache..... STP-BV " << key << " stored in " << _cacheDirectory << std::endl;
+  }
+
+  void SmoothHullGeneratorVVR::buildVVR_Prime(STPBV& stpbv)
+  {
     std::vector<VVRsphere> smallSpheres;
     std::vector<VVRsphere> bigSpheres;
     std::vector< std::pair<int, VVRtorus> > torus;
-    std::map<int, int> tinds;
+    std::vector<int> faceEdges;
     std::vector<std::vector<VVRcone> > ssVVR;
-    std::vector<std::vector<bool> > computed(_points.size());
-    std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > > tVVR;
+    std::vector<bool> computed;
+    std::vector<std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > > tVVR;
     std::vector<SCD::faceVVR> bsVVR;
     VVRsphere stmp;
     VVRcone ctmp;
@@ -713,10 +1665,11 @@ postponed:
     SCD::faceVVR ftmp;
     double epsilon = 1e-10;
 
-    //computing hull
-    _index.clear();
-    _spheres.clear();
-    cover();
+    //dense ids of the edges of the hull
+    int nbEdges = hullEdges(faceEdges);
+    computed.assign(nbEdges, false);
+    tVVR.resize(nbEdges);
+    torus.reserve(nbEdges);
 
     std::vector<int> ind(_index.size());
     std::vector<int> invind(_points.size(),-1);
@@ -730,13 +1683,6 @@ postponed:
       invind[*it]=i;
     }
 
-    for(unsigned(i) = 0 ; i < _points.size() ; ++i)
-    {
-      computed[i].resize(_points.size());
-      for(unsigned j = 0 ; j < _points.size() ; ++j)
-        computed[i][j] = false;
-    }
-
     for(std::vector<vector3d>::const_iterator it = _points.begin() ;
         it != _points.end() ;
         ++it)
@@ -756,8 +1702,8 @@ postponed:
       stmp._radius = _R;
       bigSpheres.push_back(stmp);
 
-      tind = getKey((*it)._point1, (*it)._point2);
-      if(!computed[(*it)._point1][(*it)._point2])
+      tind = faceEdges[3*scount+0];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point1] + _points[(*it)._point2]) / 2;
@@ -765,14 +1711,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point1] - _points[(*it)._point2]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane1.first = tinds[tind];
+      ftmp._plane1.first = tind;
       ftmp._plane1.second = (_points[(*it)._point1] - stmp._center)^(_points[(*it)._point2] - stmp._center);
       ftmp._plane1.second /= ftmp._plane1.second.norm();
 
-      if(!computed[(*it)._point1][(*it)._point2])
+      if(!computed[tind])
       {
         //register the VVR plane for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane1;
@@ -792,9 +1737,9 @@ postponed:
         ssVVR[(*it)._point2].push_back(ctmp);
         ctmp.first = (*it)._point2;
         tpair.first.second = ctmp;
-        computed[(*it)._point1][(*it)._point2] = computed[(*it)._point2][(*it)._point1] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -803,8 +1748,8 @@ postponed:
         tVVR[tind].second.second.first = scount;
       }
 
-      tind = getKey((*it)._point2, (*it)._point3);
-      if(!computed[(*it)._point2][(*it)._point3])
+      tind = faceEdges[3*scount+1];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point2] + _points[(*it)._point3]) / 2;
@@ -812,14 +1757,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point2] - _points[(*it)._point3]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane2.first = tinds[tind];
+      ftmp._plane2.first = tind;
       ftmp._plane2.second = (_points[(*it)._point2] - stmp._center)^(_points[(*it)._point3] - stmp._center);
       ftmp._plane2.second /= ftmp._plane2.second.norm();
 
-      if(!computed[(*it)._point2][(*it)._point3])
+      if(!computed[tind])
       {
         //register the VVR cone for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane2;
@@ -839,9 +1783,9 @@ postponed:
         ssVVR[(*it)._point3].push_back(ctmp);
         ctmp.first = (*it)._point3;
         tpair.first.second = ctmp;
-        computed[(*it)._point2][(*it)._point3] = computed[(*it)._point3][(*it)._point2] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -850,8 +1794,8 @@ postponed:
         tVVR[tind].second.second.first = scount;
       }
 
-      tind = getKey((*it)._point3, (*it)._point1);
-      if(!computed[(*it)._point3][(*it)._point1])
+      tind = faceEdges[3*scount+2];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point3] + _points[(*it)._point1]) / 2;
@@ -859,14 +1803,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point3] - _points[(*it)._point1]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane3.first = tinds[tind];
+      ftmp._plane3.first = tind;
       ftmp._plane3.second = (_points[(*it)._point3] - stmp._center)^(_points[(*it)._point1] - stmp._center);
       ftmp._plane3.second /= ftmp._plane3.second.norm();
 
-      if(!computed[(*it)._point3][(*it)._point1])
+      if(!computed[tind])
       {
         //register the VVR cone for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane3;
@@ -886,9 +1829,9 @@ postponed:
         ssVVR[(*it)._point1].push_back(ctmp);
         ctmp.first = (*it)._point1;
         tpair.first.second = ctmp;
-        computed[(*it)._point3][(*it)._point1] = computed[(*it)._point1][(*it)._point3] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -915,11 +1858,10 @@ postponed:
       bsVVR[i]._plane2.first = smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane2.first;
       bsVVR[i]._plane3.first = smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane3.first;
     }
-    for(std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >::iterator it = tVVR.begin() ;
-        it != tVVR.end() ; ++it)
+    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      it->second.second.first.first += smallSpheres.size();
-      it->second.second.second.first += smallSpheres.size();
+      tVVR[it->first].second.first.first += smallSpheres.size();
+      tVVR[it->first].second.second.first += smallSpheres.size();
     }
 
     //sort the data to erase the useless toruses
@@ -935,26 +1877,27 @@ postponed:
       - bug sphere: keep the limit VVR but change the ID of the outBV >> other side sphere
       (this whole step is only realized for the VVR of the small/bug spheres, nothing changes regarding the BV)
      */
-    std::map<int, bool> torusToErase, torusToEraseID;
+    std::vector<bool> torusToErase(torus.size(), false);
+    std::map<int, bool> torusToEraseID;
     std::multimap<int, int> linkedsSphereIDs;
     std::multimap<int, std::pair<int, int> > linkedbSphereIDs;
     //find the useless toruses : those for which the two linked big spheres have the same center;
     //and store the data to make the needed changes after
     int currentTorusID;
-    for(std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >::iterator it = tVVR.begin() ;
-        it != tVVR.end() ; ++it)
+    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      int firstID = it->second.second.first.first - smallSpheres.size();
-      int secondID = it->second.second.second.first - smallSpheres.size();
+      std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> >& tv = tVVR[it->first];
+      int firstID = tv.second.first.first - smallSpheres.size();
+      int secondID = tv.second.second.first - smallSpheres.size();
       if((bigSpheres[firstID]._center - bigSpheres[secondID]._center).normsquared() < epsilon)
       {
-        currentTorusID = smallSpheres.size() + bigSpheres.size() + tinds[it->first];
+        currentTorusID = smallSpheres.size() + bigSpheres.size() + it->first;
         torusToEraseID.insert(std::pair<int, bool>(currentTorusID, true));
-        torusToErase.insert(std::pair<int, bool>(it->first, true));
-        linkedsSphereIDs.insert(std::pair<int, int>(it->second.first.first.first, currentTorusID));
-        linkedsSphereIDs.insert(std::pair<int, int>(it->second.first.second.first, currentTorusID));
-        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(it->second.second.first.first, std::pair<int, int>(currentTorusID, it->second.second.second.first)));
-        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(it->second.second.second.first, std::pair<int, int>(currentTorusID, it->second.second.first.first)));
+        torusToErase[it->first] = true;
+        linkedsSphereIDs.insert(std::pair<int, int>(tv.first.first.first, currentTorusID));
+        linkedsSphereIDs.insert(std::pair<int, int>(tv.first.second.first, currentTorusID));
+        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(tv.second.first.first, std::pair<int, int>(currentTorusID, tv.second.second.first)));
+        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(tv.second.second.first, std::pair<int, int>(currentTorusID, tv.second.first.first)));
       }
     }
 
@@ -1031,124 +1974,48 @@ postponed:
 
 
 
-    //write data into a file
-    os.open(filename.c_str());
-    os.precision(16);
-    os<<_r<<" "<<_R<<std::endl;
-
-    os<<" "<< ind.size() << std::endl;
-    i = 0;
-
-
-    for(std::vector<int>::const_iterator it = ind.begin() ; it != ind.end() ; ++it)
+    //the patches as written in the file : the ids are the ranks among the vertices of the STP-BV
+    stpbv._r = _r;
+    stpbv._R = _R;
+    stpbv._smallSpheres.resize(ind.size());
+    for (i=0; i<int(ind.size()); ++i)
     {
-      os << smallSpheres[*it]._radius << " " << smallSpheres[*it]._center.x << " " << smallSpheres[*it]._center.y << " " << smallSpheres[*it]._center.z << std::endl;
-
-      //VVR
-      os << ssVVR[ind[i]].size() << std::endl;
-      for(std::vector<SCD::VVRcone>::const_iterator it2 = ssVVR[ind[i]].begin() ; it2 != ssVVR[ind[i]].end() ; ++it2)
-      {
-        os << it2->first-difference << " ";
-        os << it2->second._cosangle << " ";
-        os << it2->second._axis.x << " " << it2->second._axis.y << " " << it2->second._axis.z << std::endl;
-      }
-
-      ++i;
+      STPBVSmallSphere& ss = stpbv._smallSpheres[i];
+      ss._sphere = smallSpheres[ind[i]];
+      ss._vvr = ssVVR[ind[i]];
+      for (std::vector<VVRcone>::iterator it = ss._vvr.begin() ; it != ss._vvr.end() ; ++it)
+        it->first -= difference;
     }
-    i = 0;
-    os << bigSpheres.size() << std::endl;
-    for(std::vector<SCD::VVRsphere>::const_iterator it = bigSpheres.begin() ; it != bigSpheres.end() ; ++it)
+    stpbv._bigSpheres.resize(bigSpheres.size());
+    for (i=0; i<int(bigSpheres.size()); ++i)
     {
-      os << it->_radius << " " << it->_center.x << " " << it->_center.y << " " << it->_center.z << std::endl;
-      //face vertices
-      os << _points[_spheres[i]._point1].x << " " << _points[_spheres[i]._point1].y << " " << _points[_spheres[i]._point1].z << " ";
-      os << _points[_spheres[i]._point2].x << " " << _points[_spheres[i]._point2].y << " " << _points[_spheres[i]._point2].z << " ";
-      os << _points[_spheres[i]._point3].x << " " << _points[_spheres[i]._point3].y << " " << _points[_spheres[i]._point3].z << std::endl;
-
-      //VVR
-      os << bsVVR[i]._plane1.first-difference << " ";
-      os << bsVVR[i]._plane1.second.x << " " << bsVVR[i]._plane1.second.y << " " << bsVVR[i]._plane1.second.z << std::endl;
-      os << bsVVR[i]._plane2.first-difference << " ";
-      os << bsVVR[i]._plane2.second.x << " " << bsVVR[i]._plane2.second.y << " " << bsVVR[i]._plane2.second.z << std::endl;
-      os << bsVVR[i]._plane3.first-difference << " ";
-      os << bsVVR[i]._plane3.second.x << " " << bsVVR[i]._plane3.second.y << " " << bsVVR[i]._plane3.second.z << std::endl;
-
-      ++i;
+      STPBVBigSphere& bs = stpbv._bigSpheres[i];
+      bs._sphere = bigSpheres[i];
+      bs._vertices[0] = _points[_spheres[i]._point1];
+      bs._vertices[1] = _points[_spheres[i]._point2];
+      bs._vertices[2] = _points[_spheres[i]._point3];
+      bs._vvr = bsVVR[i];
+      bs._vvr._plane1.first -= difference;
+      bs._vvr._plane2.first -= difference;
+      bs._vvr._plane3.first -= difference;
     }
-    os << torus.size() << std::endl;
-    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
+    stpbv._tori.resize(torus.size());
+    for (i=0; i<int(torus.size()); ++i)
     {
-      if(torusToErase.find(it->first) != torusToErase.end())
-        os << false << std::endl;
-      else
-        os << true << std::endl;
-      os << it->second._extRadius << " ";
-      os << _R << " ";
-      os << it->second._center.x << " " << it->second._center.y << " " << it->second._center.z << " ";
-      os << it->second._normal.x << " " << it->second._normal.y << " " << it->second._normal.z << std::endl;
-
-      //VVR
-      os << invind[tVVR[it->first].first.first.first] << " ";
-      os << tVVR[it->first].first.first.second._cosangle << " ";
-      os << tVVR[it->first].first.first.second._axis.x << " ";
-      os << tVVR[it->first].first.first.second._axis.y << " ";
-      os << tVVR[it->first].first.first.second._axis.z << std::endl;
-      os << invind[tVVR[it->first].first.second.first] << " ";
-      os << tVVR[it->first].first.second.second._cosangle << " ";
-      os << tVVR[it->first].first.second.second._axis.x << " ";
-      os << tVVR[it->first].first.second.second._axis.y << " ";
-      os << tVVR[it->first].first.second.second._axis.z << std::endl;
-      os << tVVR[it->first].second.first.first-difference << " ";
-      os << tVVR[it->first].second.first.second.x << " ";
-      os << tVVR[it->first].second.first.second.y << " ";
-      os << tVVR[it->first].second.first.second.z << std::endl;
-      os << tVVR[it->first].second.second.first-difference << " ";
-      os << tVVR[it->first].second.second.second.x << " ";
-      os << tVVR[it->first].second.second.second.y << " ";
-      os << tVVR[it->first].second.second.second.z << std::endl;
+      STPBVTorus& t = stpbv._tori[i];
+      const std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> >& tv = tVVR[torus[i].first];
+      t._used = !torusToErase[torus[i].first];
+      t._torus = torus[i].second;
+      t._radius = _R;
+      t._cones[0] = tv.first.first;
+      t._cones[0].first = invind[tv.first.first.first];
+      t._cones[1] = tv.first.second;
+      t._cones[1].first = invind[tv.first.second.first];
+      t._planes[0] = tv.second.first;
+      t._planes[0].first -= difference;
+      t._planes[1] = tv.second.second;
+      t._planes[1].first -= difference;
     }
-
-    /*for(int i = 0 ; i < smallSpheres.size() ; ++i)
-      {
-      os << ssVVR[i].size() << std::endl;
-      for(std::vector<SCD::VVRcone>::const_iterator it2 = ssVVR[i].begin() ; it2 != ssVVR[i].end() ; ++it2)
-      {
-      os << (smallSpheres.size() + bigSpheres.size() + it2->first) << " ";
-      os << it2->second._cosangle << " ";
-      os << it2->second._axis.x << " " << it2->second._axis.y << " " << it2->second._axis.z << std::endl;
-      }
-      }
-      for(int i = 0; i < bigSpheres.size() ; ++i)
-      {
-      os << (smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane1.first) << " ";
-      os << bsVVR[i]._plane1.second.x << " " << bsVVR[i]._plane1.second.y << " " << bsVVR[i]._plane1.second.z << std::endl;
-      os << (smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane2.first) << " ";
-      os << bsVVR[i]._plane2.second.x << " " << bsVVR[i]._plane2.second.y << " " << bsVVR[i]._plane2.second.z << std::endl;
-      os << (smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane3.first) << " ";
-      os << bsVVR[i]._plane3.second.x << " " << bsVVR[i]._plane3.second.y << " " << bsVVR[i]._plane3.second.z << std::endl;
-      }
-      for(std::vector< std::pair<int, Torus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
-      {
-      os << tVVR[it->first].first.first.first << " ";
-      os << tVVR[it->first].first.first.second._cosangle << " ";
-      os << tVVR[it->first].first.first.second._axis.x << " ";
-      os << tVVR[it->first].first.first.second._axis.y << " ";
-      os << tVVR[it->first].first.first.second._axis.z << std::endl;
-      os << tVVR[it->first].first.second.first << " ";
-      os << tVVR[it->first].first.second.second._cosangle << " ";
-      os << tVVR[it->first].first.second.second._axis.x << " ";
-      os << tVVR[it->first].first.second.second._axis.y << " ";
-      os << tVVR[it->first].first.second.second._axis.z << std::endl;
-      os << (smallSpheres.size() + tVVR[it->first].second.first.first) << " ";
-      os << tVVR[it->first].second.first.second.x << " ";
-      os << tVVR[it->first].second.first.second.y << " ";
-      os << tVVR[it->first].second.first.second.z << std::endl;
-      os << (smallSpheres.size() + tVVR[it->first].second.second.first) << " ";
-      os << tVVR[it->first].second.second.second.x << " ";
-      os << tVVR[it->first].second.second.second.y << " ";
-      os << tVVR[it->first].second.second.second.z << std::endl;
-      }*/
-    os.close();
   }
 
 
@@ -1158,10 +2025,10 @@ postponed:
     std::vector<VVRsphere> smallSpheres;
     std::vector<VVRsphere> bigSpheres;
     std::vector< std::pair<int, VVRtorus> > torus;
-    std::map<int, int> tinds;
+    std::vector<int> faceEdges;
     std::vector<std::vector<VVRcone> > ssVVR;
-    std::vector<std::vector<bool> > computed(_points.size());
-    std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > > tVVR;
+    std::vector<bool> computed;
+    std::vector<std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > > tVVR;
     std::vector<SCD::faceVVR> bsVVR;
     VVRsphere stmp;
     VVRcone ctmp;
@@ -1178,12 +2045,11 @@ postponed:
     _spheres.clear();
     cover();
 
-    for(i = 0 ; i < _points.size() ; ++i)
-    {
-      computed[i].resize(_points.size());
-      for(int j = 0 ; j < _points.size() ; ++j)
-        computed[i][j] = false;
-    }
+    //dense ids of the edges of the hull
+    int nbEdges = hullEdges(faceEdges);
+    computed.assign(nbEdges, false);
+    tVVR.resize(nbEdges);
+    torus.reserve(nbEdges);
 
     for(std::vector<vector3d>::const_iterator it = _points.begin() ;
         it != _points.end() ;
@@ -1204,8 +2070,8 @@ postponed:
       stmp._radius = _R;
       bigSpheres.push_back(stmp);
 
-      tind = getKey((*it)._point1, (*it)._point2);
-      if(!computed[(*it)._point1][(*it)._point2])
+      tind = faceEdges[3*scount+0];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point1] + _points[(*it)._point2]) / 2;
@@ -1213,14 +2079,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point1] - _points[(*it)._point2]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane1.first = tinds[tind];
+      ftmp._plane1.first = tind;
       ftmp._plane1.second = (_points[(*it)._point1] - stmp._center)^(_points[(*it)._point2] - stmp._center);
       ftmp._plane1.second /= ftmp._plane1.second.norm();
 
-      if(!computed[(*it)._point1][(*it)._point2])
+      if(!computed[tind])
       {
         //register the VVR plane for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane1;
@@ -1240,9 +2105,9 @@ postponed:
         ssVVR[(*it)._point2].push_back(ctmp);
         ctmp.first = (*it)._point2;
         tpair.first.second = ctmp;
-        computed[(*it)._point1][(*it)._point2] = computed[(*it)._point2][(*it)._point1] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -1251,8 +2116,8 @@ postponed:
         tVVR[tind].second.second.first = scount;
       }
 
-      tind = getKey((*it)._point2, (*it)._point3);
-      if(!computed[(*it)._point2][(*it)._point3])
+      tind = faceEdges[3*scount+1];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point2] + _points[(*it)._point3]) / 2;
@@ -1260,14 +2125,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point2] - _points[(*it)._point3]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane2.first = tinds[tind];
+      ftmp._plane2.first = tind;
       ftmp._plane2.second = (_points[(*it)._point2] - stmp._center)^(_points[(*it)._point3] - stmp._center);
       ftmp._plane2.second /= ftmp._plane2.second.norm();
 
-      if(!computed[(*it)._point2][(*it)._point3])
+      if(!computed[tind])
       {
         //register the VVR cone for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane2;
@@ -1287,9 +2151,9 @@ postponed:
         ssVVR[(*it)._point3].push_back(ctmp);
         ctmp.first = (*it)._point3;
         tpair.first.second = ctmp;
-        computed[(*it)._point2][(*it)._point3] = computed[(*it)._point3][(*it)._point2] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -1298,8 +2162,8 @@ postponed:
         tVVR[tind].second.second.first = scount;
       }
 
-      tind = getKey((*it)._point3, (*it)._point1);
-      if(!computed[(*it)._point3][(*it)._point1])
+      tind = faceEdges[3*scount+2];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point3] + _points[(*it)._point1]) / 2;
@@ -1307,14 +2171,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point3] - _points[(*it)._point1]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane3.first = tinds[tind];
+      ftmp._plane3.first = tind;
       ftmp._plane3.second = (_points[(*it)._point3] - stmp._center)^(_points[(*it)._point1] - stmp._center);
       ftmp._plane3.second /= ftmp._plane3.second.norm();
 
-      if(!computed[(*it)._point3][(*it)._point1])
+      if(!computed[tind])
       {
         //register the VVR cone for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane3;
@@ -1334,9 +2197,9 @@ postponed:
         ssVVR[(*it)._point1].push_back(ctmp);
         ctmp.first = (*it)._point1;
         tpair.first.second = ctmp;
-        computed[(*it)._point3][(*it)._point1] = computed[(*it)._point1][(*it)._point3] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -1363,11 +2226,10 @@ postponed:
       bsVVR[i]._plane2.first = smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane2.first;
       bsVVR[i]._plane3.first = smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane3.first;
     }
-    for(std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >::iterator it = tVVR.begin() ;
-        it != tVVR.end() ; ++it)
+    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      it->second.second.first.first += smallSpheres.size();
-      it->second.second.second.first += smallSpheres.size();
+      tVVR[it->first].second.first.first += smallSpheres.size();
+      tVVR[it->first].second.second.first += smallSpheres.size();
     }
 
     //sort the data to erase the useless toruses
@@ -1383,26 +2245,27 @@ postponed:
       - bug sphere: keep the limit VVR but change the ID of the outBV >> other side sphere
       (this whole step is only realized for the VVR of the small/bug spheres, nothing changes regarding the BV)
      */
-    std::map<int, bool> torusToErase, torusToEraseID;
+    std::vector<bool> torusToErase(torus.size(), false);
+    std::map<int, bool> torusToEraseID;
     std::multimap<int, int> linkedsSphereIDs;
     std::multimap<int, std::pair<int, int> > linkedbSphereIDs;
     //find the useless toruses : those for which the two linked big spheres have the same center;
     //and store the data to make the needed changes after
     int currentTorusID;
-    for(std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >::iterator it = tVVR.begin() ;
-        it != tVVR.end() ; ++it)
+    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      int firstID = it->second.second.first.first - smallSpheres.size();
-      int secondID = it->second.second.second.first - smallSpheres.size();
+      std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> >& tv = tVVR[it->first];
+      int firstID = tv.second.first.first - smallSpheres.size();
+      int secondID = tv.second.second.first - smallSpheres.size();
       if((bigSpheres[firstID]._center - bigSpheres[secondID]._center).normsquared() < epsilon)
       {
-        currentTorusID = smallSpheres.size() + bigSpheres.size() + tinds[it->first];
+        currentTorusID = smallSpheres.size() + bigSpheres.size() + it->first;
         torusToEraseID.insert(std::pair<int, bool>(currentTorusID, true));
-        torusToErase.insert(std::pair<int, bool>(it->first, true));
-        linkedsSphereIDs.insert(std::pair<int, int>(it->second.first.first.first, currentTorusID));
-        linkedsSphereIDs.insert(std::pair<int, int>(it->second.first.second.first, currentTorusID));
-        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(it->second.second.first.first, std::pair<int, int>(currentTorusID, it->second.second.second.first)));
-        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(it->second.second.second.first, std::pair<int, int>(currentTorusID, it->second.second.first.first)));
+        torusToErase[it->first] = true;
+        linkedsSphereIDs.insert(std::pair<int, int>(tv.first.first.first, currentTorusID));
+        linkedsSphereIDs.insert(std::pair<int, int>(tv.first.second.first, currentTorusID));
+        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(tv.second.first.first, std::pair<int, int>(currentTorusID, tv.second.second.first)));
+        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(tv.second.second.first, std::pair<int, int>(currentTorusID, tv.second.first.first)));
       }
     }
 
@@ -1526,7 +2389,7 @@ postponed:
     os << torus.size() << std::endl;
     for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      if(torusToErase.find(it->first) != torusToErase.end())
+      if(torusToErase[it->first])
         os << false << std::endl;
       else
         os << true << std::endl;
@@ -1606,10 +2469,10 @@ postponed:
     std::vector<VVRsphere> smallSpheres;
     std::vector<VVRsphere> bigSpheres;
     std::vector< std::pair<int, VVRtorus> > torus;
-    std::map<int, int> tinds;
+    std::vector<int> faceEdges;
     std::vector<std::vector<VVRcone> > ssVVR;
-    std::vector<std::vector<bool> > computed(_points.size());
-    std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > > tVVR;
+    std::vector<bool> computed;
+    std::vector<std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > > tVVR;
     std::vector<SCD::faceVVR> bsVVR;
     VVRsphere stmp;
     VVRcone ctmp;
@@ -1626,6 +2489,12 @@ postponed:
     _spheres.clear();
     cover();
 
+    //dense ids of the edges of the hull
+    int nbEdges = hullEdges(faceEdges);
+    computed.assign(nbEdges, false);
+    tVVR.resize(nbEdges);
+    torus.reserve(nbEdges);
+
     std::vector<int> ind(_index.size());
     std::vector<int> invind(_points.size(),-1);
 
@@ -1638,13 +2507,6 @@ postponed:
       invind[*it]=i;
     }
 
-    for(i = 0 ; i < _points.size() ; ++i)
-    {
-      computed[i].resize(_points.size());
-      for(int j = 0 ; j < _points.size() ; ++j)
-        computed[i][j] = false;
-    }
-
     for(std::vector<vector3d>::const_iterator it = _points.begin() ;
         it != _points.end() ;
         ++it)
@@ -1664,8 +2526,8 @@ postponed:
       stmp._radius = _R;
       bigSpheres.push_back(stmp);
 
-      tind = getKey((*it)._point1, (*it)._point2);
-      if(!computed[(*it)._point1][(*it)._point2])
+      tind = faceEdges[3*scount+0];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point1] + _points[(*it)._point2]) / 2;
@@ -1673,14 +2535,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point1] - _points[(*it)._point2]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane1.first = tinds[tind];
+      ftmp._plane1.first = tind;
       ftmp._plane1.second = (_points[(*it)._point1] - stmp._center)^(_points[(*it)._point2] - stmp._center);
       ftmp._plane1.second /= ftmp._plane1.second.norm();
 
-      if(!computed[(*it)._point1][(*it)._point2])
+      if(!computed[tind])
       {
         //register the VVR plane for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane1;
@@ -1700,9 +2561,9 @@ postponed:
         ssVVR[(*it)._point2].push_back(ctmp);
         ctmp.first = (*it)._point2;
         tpair.first.second = ctmp;
-        computed[(*it)._point1][(*it)._point2] = computed[(*it)._point2][(*it)._point1] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -1711,8 +2572,8 @@ postponed:
         tVVR[tind].second.second.first = scount;
       }
 
-      tind = getKey((*it)._point2, (*it)._point3);
-      if(!computed[(*it)._point2][(*it)._point3])
+      tind = faceEdges[3*scount+1];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point2] + _points[(*it)._point3]) / 2;
@@ -1720,14 +2581,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point2] - _points[(*it)._point3]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane2.first = tinds[tind];
+      ftmp._plane2.first = tind;
       ftmp._plane2.second = (_points[(*it)._point2] - stmp._center)^(_points[(*it)._point3] - stmp._center);
       ftmp._plane2.second /= ftmp._plane2.second.norm();
 
-      if(!computed[(*it)._point2][(*it)._point3])
+      if(!computed[tind])
       {
         //register the VVR cone for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane2;
@@ -1747,9 +2607,9 @@ postponed:
         ssVVR[(*it)._point3].push_back(ctmp);
         ctmp.first = (*it)._point3;
         tpair.first.second = ctmp;
-        computed[(*it)._point2][(*it)._point3] = computed[(*it)._point3][(*it)._point2] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -1758,8 +2618,8 @@ postponed:
         tVVR[tind].second.second.first = scount;
       }
 
-      tind = getKey((*it)._point3, (*it)._point1);
-      if(!computed[(*it)._point3][(*it)._point1])
+      tind = faceEdges[3*scount+2];
+      if(!computed[tind])
       {
         //register the torus
         ttmp._center = (_points[(*it)._point3] + _points[(*it)._point1]) / 2;
@@ -1767,14 +2627,13 @@ postponed:
         ttmp._normal = (_points[(*it)._point3] - _points[(*it)._point1]) / l;
         ttmp._extRadius = (ttmp._center - stmp._center).norm();
         torus.push_back(std::pair<int, VVRtorus>(tind, ttmp));
-        tinds.insert(std::pair<int, int>(tind, torus.size() - 1));
       }
 
-      ftmp._plane3.first = tinds[tind];
+      ftmp._plane3.first = tind;
       ftmp._plane3.second = (_points[(*it)._point3] - stmp._center)^(_points[(*it)._point1] - stmp._center);
       ftmp._plane3.second /= ftmp._plane3.second.norm();
 
-      if(!computed[(*it)._point3][(*it)._point1])
+      if(!computed[tind])
       {
         //register the VVR cone for the big sphere and torus in the torus
         tpair.second.first = ftmp._plane3;
@@ -1794,9 +2653,9 @@ postponed:
         ssVVR[(*it)._point1].push_back(ctmp);
         ctmp.first = (*it)._point1;
         tpair.first.second = ctmp;
-        computed[(*it)._point3][(*it)._point1] = computed[(*it)._point1][(*it)._point3] = true;
+        computed[tind] = true;
 
-        tVVR.insert(std::pair<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >(tind, tpair));
+        tVVR[tind] = tpair;
       }
       else
       {
@@ -1823,11 +2682,10 @@ postponed:
       bsVVR[i]._plane2.first = smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane2.first;
       bsVVR[i]._plane3.first = smallSpheres.size() + bigSpheres.size() + bsVVR[i]._plane3.first;
     }
-    for(std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >::iterator it = tVVR.begin() ;
-        it != tVVR.end() ; ++it)
+    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      it->second.second.first.first += smallSpheres.size();
-      it->second.second.second.first += smallSpheres.size();
+      tVVR[it->first].second.first.first += smallSpheres.size();
+      tVVR[it->first].second.second.first += smallSpheres.size();
     }
 
     //sort the data to erase the useless toruses
@@ -1843,26 +2701,27 @@ postponed:
       - bug sphere: keep the limit VVR but change the ID of the outBV >> other side sphere
       (this whole step is only realized for the VVR of the small/bug spheres, nothing changes regarding the BV)
      */
-    std::map<int, bool> torusToErase, torusToEraseID;
+    std::vector<bool> torusToErase(torus.size(), false);
+    std::map<int, bool> torusToEraseID;
     std::multimap<int, int> linkedsSphereIDs;
     std::multimap<int, std::pair<int, int> > linkedbSphereIDs;
     //find the useless toruses : those for which the two linked big spheres have the same center;
     //and store the data to make the needed changes after
     int currentTorusID;
-    for(std::map<int, std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> > >::iterator it = tVVR.begin() ;
-        it != tVVR.end() ; ++it)
+    for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      int firstID = it->second.second.first.first - smallSpheres.size();
-      int secondID = it->second.second.second.first - smallSpheres.size();
+      std::pair<std::pair<VVRcone, VVRcone>, std::pair<VVRplane, VVRplane> >& tv = tVVR[it->first];
+      int firstID = tv.second.first.first - smallSpheres.size();
+      int secondID = tv.second.second.first - smallSpheres.size();
       if((bigSpheres[firstID]._center - bigSpheres[secondID]._center).normsquared() < epsilon)
       {
-        currentTorusID = smallSpheres.size() + bigSpheres.size() + tinds[it->first];
+        currentTorusID = smallSpheres.size() + bigSpheres.size() + it->first;
         torusToEraseID.insert(std::pair<int, bool>(currentTorusID, true));
-        torusToErase.insert(std::pair<int, bool>(it->first, true));
-        linkedsSphereIDs.insert(std::pair<int, int>(it->second.first.first.first, currentTorusID));
-        linkedsSphereIDs.insert(std::pair<int, int>(it->second.first.second.first, currentTorusID));
-        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(it->second.second.first.first, std::pair<int, int>(currentTorusID, it->second.second.second.first)));
-        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(it->second.second.second.first, std::pair<int, int>(currentTorusID, it->second.second.first.first)));
+        torusToErase[it->first] = true;
+        linkedsSphereIDs.insert(std::pair<int, int>(tv.first.first.first, currentTorusID));
+        linkedsSphereIDs.insert(std::pair<int, int>(tv.first.second.first, currentTorusID));
+        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(tv.second.first.first, std::pair<int, int>(currentTorusID, tv.second.second.first)));
+        linkedbSphereIDs.insert(std::pair<int, std::pair<int, int> >(tv.second.second.first, std::pair<int, int>(currentTorusID, tv.second.first.first)));
       }
     }
 
@@ -1986,7 +2845,7 @@ postponed:
     os << torus.size() << std::endl;
     for(std::vector< std::pair<int, VVRtorus> >::const_iterator it = torus.begin() ; it != torus.end() ; ++it)
     {
-      if(torusToErase.find(it->first) != torusToErase.end())
+      if(torusToErase[it->first])
         os << false << std::endl;
       else
         os << true << std::endl;
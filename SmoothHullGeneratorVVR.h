@@ -20,8 +20,14 @@
 #include <fstream>
 #include <string>
 #include <algorithm>
+#include <functional>
 
 #include "vector3.h"
+#include "EdgeHash.h"
+#include "FarthestPointTree.h"
+#include "SphereKernels.h"
+#include "SpherePredicates.h"
+#include "STPBV.h"
 
 
 /*! \namespace SCD
@@ -50,66 +56,6 @@ namespace SCD
     vector3d	_center;
   };
 
-  /*! \class VVRsphere
-   *	\brief %Class VVRsphere
-   *	\author Cochet-Grasset Amelie
-   *	\version 0.0.0
-   *	\date 07.10.22
-   *	\bug None
-   *	\warning None
-   *
-   * A sphere
-   */
-  struct VVRsphere
-  {
-    double		_radius;
-    vector3d		_center;
-  };
-
-  /*! \class VVRtorus
-   *	\brief %Class VVRtorus
-   *	\author Cochet-Grasset Amelie
-   *	\version 0.0.0
-   *	\date 07.10.22
-   *	\bug None
-   *	\warning None
-   *
-   * A Torus without the inner radius
-   */
-  struct VVRtorus
-  {
-    double		_extRadius;
-    vector3d	_center;
-    vector3d		_normal;
-  };
-
-  /*! \class Cone
-   *	\brief %Class Cone
-   *	\author Cochet-Grasset Amelie
-   *	\version 0.0.0
-   *	\date 07.07
-   *	\bug None
-   *	\warning None
-   *
-   * A sphere
-   */
-  struct Cone
-  {
-    double _cosangle;
-    vector3d		 _axis;
-  };
-
-  typedef std::pair<int, vector3d> VVRplane;
-  typedef std::pair<int, Cone> VVRcone;
-
-  struct faceVVR
-  {
-    VVRplane _plane1;
-    VVRplane _plane2;
-    VVRplane _plane3;
-  };
-
-
   /*! \class SmoothHullGeneratorVVR
    *	\brief %Class SmoothHullGeneratorVVR
    *	\author Escande Adrien
@@ -135,44 +81,182 @@ namespace SCD
       vector3d		_previousCenter;	//center of the sphere we turn (/come) from
     };
 
+    struct pivotCandidate
+    {
+      double		_pseudoAngle;		//monotone with the rotation angle, without acos (a lower bound in float)
+      int			_point;
+      bool operator>(const pivotCandidate& pc) const
+      {
+        return (_pseudoAngle > pc._pseudoAngle) || (_pseudoAngle == pc._pseudoAngle && _point > pc._point);
+      }
+      bool operator<(const pivotCandidate& pc) const
+      {
+        return pc > *this;
+      }
+    };
+
+    //buffers of the rotation around an edge, one per thread
+    struct pivotWorkspace
+    {
+      alignedDoubles				_cx;				//centers and pseudo angles of all the points
+      alignedDoubles				_cy;
+      alignedDoubles				_cz;
+      alignedDoubles				_pseudoAngle;
+      alignedDoubles				_key;				//pseudo angles, or their lower bounds, order of the tests
+      alignedFloats					_halfTangent;		//tangents of the half angles and their errors in float,
+      alignedFloats					_error;				//with mixed precision
+      std::vector<char>				_state;
+      std::vector<pivotCandidate>	_candidates;		//the next ones, in a heap
+    };
+
+    struct edgePivot
+    {
+      int			_p3;				//the turnData the rotation was computed for
+      vector3d		_previousCenter;
+      int			_point;				//chosen vertex, -1 if no sphere contains all the points
+      vector3d		_center;
+      double		_angle;
+      double		_key;				//absolute angle, priority of the edge
+    };
+
+    //edge of the border of the faces removed by an insertion
+    struct borderEdge
+    {
+      int			_p1;				//oriented as in the face removed
+      int			_p2;
+      int			_inner;				//face removed
+      int			_outer;				//face kept
+    };
+
   public:
     SmoothHullGeneratorVVR(double r, double R);
-    SmoothHullGeneratorVVR(std::vector<vector3d>& points, double r, double R);
+    //on a cloud in memory, instead of loadGeometry
+    SmoothHullGeneratorVVR(const std::vector<vector3d>& points, double r, double R);
 
   public:
-    //WARNING : be sure that there is no double points in the cloud
-    void	loadGeometry(const std::string& filename);
+    //WARNING : be sure that there is no double points in the cloud, or weld them (see setWelding)
+    //the file is a cloud or a mesh whose vertices are taken, without their duplicates (see readPoints).
+    //Returns false if it can't be read
+    bool	loadGeometry(const std::string& filename);
     void	compute3DSMaxHull(const std::string& rootPath);
     void	computeSmoothHull(std::vector<vector3d>& outPoints, std::vector<VVRSFace>& outSFaces);
     void	computeVVR(const std::string& filename);
     void	computeVVR_WithPolyhedron(const std::string& filename);
     void	computeVVR_Prime(const std::string& filename);
+    //one output per pair (r,R) : the STP-BV is computed once per value of R-r, the only parameter of its
+    //faces, by decreasing R-r and from the vertices of the previous one. The pairs share a computation if
+    //their values of R-r are equal as doubles (0.1,0.3 and 0.2,0.4 may not). The parameters of each pair
+    //are written to the output stream
+    void	computeVVR_Prime(const std::vector<std::pair<double, double> >& radii, const std::vector<std::string>& filenames);
+    //the same in memory, without writing it
+    void	computeVVR_Prime(STPBV& stpbv);
+    //write the STP-BV computed last, or updated by insertPoints, in the format of computeVVR_Prime
+    void	outputVVR_Prime(const std::string& filename);
+    //add points to the cloud of the STP-BV computed last and update it locally, at a cost proportional
+    //to the faces that change (the STP-BV is computed if there is none)
+    void	insertPoints(const std::vector<vector3d>& points);
+    bool	insertGeometry(const std::string& filename);
+    //change the radii of the STP-BV. The one computed is kept if R-r does not change, and its vertices are
+    //the only candidates of the next computation if R-r decreases
+    void	setRadii(double r, double R);
+    //discard the points strictly inside the convex hull before building the STP-BV (default true). The STP-BV is
+    //the same, but the order of its patches may differ : the priority of the edges of the front depends on the
+    //points which give no sphere through them, interior ones included
+    void	setHullFilter(bool filter);
+    //number of threads evaluating the candidate vertices of the rotations (default 1, 0 for all the cores)
+    void	setThreads(int threads);
+    //number of front edges whose successors are pivoted ahead, in parallel (default 0 : none)
+    //the result is the same as without speculation
+    void	setSpeculation(int edges);
+    //filter the candidate vertices in float on the cloud normalized to the unit box, the double computation
+    //is only done for the cases the float one cannot decide (default false). The result is the same
+    void	setMixedPrecision(bool mixed);
+    //merge the points of the cloud closer than tolerance when loading it, each to the first one of its group
+    //in the file (default -1 : no welding, 0 merges the exact duplicates only)
+    void	setWelding(double tolerance);
+    //reduce the cloud when loading it (after the welding) : the points strictly inside its convex hull are removed,
+    //the others are clustered on a grid and the outermost point of each cell is kept. The cells are chosen to keep
+    //at most count points if count > 0, otherwise for an outward error below tolerance if tolerance > 0 (default
+    //0, 0 : no decimation). The outward error is reported : the STP-BV of the kept points with r inflated by it
+    //contains the STP-BV of the whole cloud
+    void	setDecimation(double tolerance, unsigned int count = 0);
+    //format of the files written by computeVVR_Prime and outputVVR_Prime (default STPBV_TEXT)
+    void	setOutputFormat(STPBVFormat format);
+    //serve the STP-BV of computeVVR_Prime from a cache directory, keyed by the points loaded, the radii and the
+    //hull filter, keeping the maxSize bytes of the most recently used ones (default "" : no cache, see STPBVCache).
+    //An STP-BV served is not computed : insertPoints computes it again, the radii overload ignores the cache
+    void	setCache(const std::string& directory, boost::uint64_t maxSize);
+    //stream of the messages of the computation, of the files read and written and of the cache (default std::cout).
+    //It is only written by the calling thread : each generator of a thread can have its own
+    void	setOutput(std::ostream& os);
 
   private:
     bool	findCenter(int p1, int p2, int p3, vector3d &center);
-    bool	isInSphere(vector3d &point, vector3d &center);
     double	distInSphere(vector3d &point, vector3d &center);
-    bool	allPointsInSphere(vector3d &center);
+    //the sphere of the face [a,b,d] exists and contains all the points, exactly and with the perturbation of
+    //the points on it (see SpherePredicates). The witness is tested first, it is replaced by the point found out
+    bool	containsAll(int a, int b, int d, int& witness);
     double	distMaxPointsInSphere(vector3d &center);
     double	computeAngle(vector3d &p1, vector3d &p2, vector3d &p3, vector3d &axe);
-    int		getKey(int a, int b);
-    int		getKey(turnData& td);
+    edgeKey	getKey(int a, int b);
+    edgeKey	getKey(turnData& td);
+    //dense ids of the edges of _spheres, in order of appearance : faceEdges[3*i+k] is the id
+    //of the edge k ([p1,p2], [p2,p3], [p3,p1]) of the face i. Returns the number of edges
+    int		hullEdges(std::vector<int>& faceEdges) const;
     double	getKeyByAngle(turnData& td);
+    const edgePivot&	pivot(turnData& td);
+    void	computePivot(turnData& td, edgePivot& ep, pivotWorkspace& ws);
+    void	exactCenter(const EdgeFrame<double>& frame, int j, pivotWorkspace& ws);
+    bool	nextCandidates(pivotWorkspace& ws, const pivotCandidate& last, unsigned int k);
+    void	pivotSuccessors(std::vector<turnData>& edges);
     void	travelCover(VVRSFace s);
     void	printSphere(VVRSFace& s);
     void	cover(void);
-    void	readVertex(const std::string& filename);
+    void	coverHullPoints(void);
+    bool	readVertex(const std::string& filename);
+    //returns the number of points merged
+    unsigned int	weldPoints(double tolerance);
+    //returns the largest distance from a removed point of the convex hull to the kept points
+    double	decimatePoints(double tolerance, unsigned int count);
     void	output(const std::string& rootPath);
+    //the patches of the STP-BV computed last
+    void	buildVVR_Prime(STPBV& stpbv);
     bool	findFirstTriangle(unsigned &i,unsigned &j,unsigned &k,vector3d &c);
+    bool	findSeedTriangle(unsigned &i,unsigned &j,unsigned &k,vector3d &c);
+    unsigned int	farthestPoint(vector3d &center);
 
   private:
     double							_r;
     double							_R;
     std::vector<vector3d>			_points;
+    SpherePredicates				_predicates;	//on _points, whatever they contain
     std::vector<VVRSFace>			_spheres;
     std::set<int,std::less<int> >	_index;
-    double							_epsilon;
+    FarthestPointTree				_tree;			//built on the points covered by cover()
+    alignedDoubles					_x;				//coordinates of the same points, by component
+    alignedDoubles					_y;
+    alignedDoubles					_z;
+    alignedFloats					_xf;			//and normalized to the unit box, in float
+    alignedFloats					_yf;
+    alignedFloats					_zf;
+    vector3d						_origin;		//normalized point = (point - _origin) * _scale
+    double							_scale;
+    const SphereKernels*			_kernels;
+    pivotWorkspace					_workspace;
+    EdgeMap<edgePivot>			_pivots;	//rotations of the edges of the front, by oriented edge
     bool							_ccw;
+    bool							_hullFilter;
+    int								_threads;
+    int								_speculation;
+    bool							_mixed;
+    double							_weld;
+    double							_decimationTolerance;
+    unsigned int					_decimationCount;
+    STPBVFormat						_format;
+    std::string						_cacheDirectory;
+    boost::uint64_t					_cacheSize;
+    std::ostream*					_output;
+    std::vector<int>				_warmStart;		//the only candidate vertices of the next cover(), if any
   };
 }
 
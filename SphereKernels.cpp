@@ -0,0 +1,758 @@
+#include "SphereKernels.h"
+#include <algorithm>
+#include <cstring>
+#include <boost/cstdint.hpp>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SCD_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace SCD
+{
+  namespace
+  {
+    inline double dist2(const double* x, const double* y, const double* z, int i, const vector3d& c)
+    {
+      double dx = c.x-x[i];
+      double dy = c.y-y[i];
+      double dz = c.z-z[i];
+      return dx*dx+dy*dy+dz*dz;
+    }
+
+    double maxDist2Scalar(const double* x, const double* y, const double* z, int n, const vector3d& c, int& arg)
+    {
+      double best = dist2(x, y, z, 0, c);
+      arg = 0;
+      for (int i=1; i<n; ++i)
+      {
+        double d = dist2(x, y, z, i, c);
+        if (d > best)
+        {
+          best = d;
+          arg = i;
+        }
+      }
+      return best;
+    }
+
+    int firstBeyondScalar(const double* x, const double* y, const double* z, int n, const vector3d& c, double d2)
+    {
+      for (int i=0; i<n; ++i)
+      {
+        if (dist2(x, y, z, i, c) > d2)
+          return i;
+      }
+      return -1;
+    }
+
+    //same operations as findCenter(p1, j, p2) then computeAngle(previousCenter, middle, center, v)
+    void edgeCentersScalar(const EdgeFrame<double>& f, const double* x, const double* y, const double* z, int n,
+                           double* cx, double* cy, double* cz, double* pseudoAngle, char* valid)
+    {
+      for (int j=0; j<n; ++j)
+      {
+        vector3d u(x[j]-f._p1.x, y[j]-f._p1.y, z[j]-f._p1.z);
+        double duv = u%f._v;
+        vector3d uv = u^f._v;
+        double nu = u.normsquared();
+        double nuv = uv.normsquared();
+        valid[j] = 0;
+        if (nuv == 0)
+          continue;
+        double a = (nu*f._nv-f._nv*duv)/(2*nuv);
+        double b = (nu*f._nv-nu*duv)/(2*nuv);
+        double t = (f._rho2-a*a*nu-b*b*f._nv-2*a*b*duv)/nuv;
+        if (t <= 0)
+          continue;
+        valid[j] = 1;
+        double c = -sqrt(t);
+        vector3d center = u*a + f._v*b + uv*c + f._p1;
+        cx[j] = center.x;
+        cy[j] = center.y;
+        cz[j] = center.z;
+
+        vector3d w(f._middle, center);
+        double cosinus = f._u%w/(f._normU*w.norm());
+        if (cosinus > 1.)
+          cosinus = 1.;
+        else if (cosinus < -1.)
+          cosinus = -1.;
+        pseudoAngle[j] = (f._v%(f._u^w) > 0.)?(1.-cosinus):(cosinus-1.);
+      }
+    }
+
+    //float version of edgeCentersScalar. The bounds follow the first order propagation of the rounding errors
+    //through the solution of findCenter (inverse of the Gram matrix of u and v, then the square root) and through
+    //the angle, floatRoundoff taking the constants. The cases where the first order is not enough are undecided.
+    //With t the rotation angle, tan(t/2) = sin(t)/(1+cos(t)), undecided close to the half turn
+    void halfTangentsFloatScalar(const EdgeFrame<float>& f, const float* x, const float* y, const float* z, int n,
+                                 float* halfTangent, float* error, char* state)
+    {
+      const float e = floatRoundoff;
+      float rho = sqrtf(f._rho2);
+      float h = sqrtf(f._rho2-f._nv/4);				//radius of the circle of the centers
+      float eu = e*(2.f+f._normU);					//error on the vector the rotation starts from
+      float rh = 1.f/h;
+      float ruh = 1.f/(f._normU*h);
+      float rvuh = ruh/sqrtf(f._nv);
+      float eun = eu/f._normU;
+      for (int j=0; j<n; ++j)
+        state[j] = 2;
+      if (!(h > 0.f && f._normU > 4.f*eu))
+        return;
+      for (int j=0; j<n; ++j)
+      {
+        vector3f u(x[j]-f._p1.x, y[j]-f._p1.y, z[j]-f._p1.z);
+        float duv = u%f._v;
+        vector3f uv = u^f._v;
+        float nu = u.normsquared();
+        float nuv = uv.normsquared();
+        float l2 = nu+f._nv;
+        float l = sqrtf(l2);
+        float s = 2.f+l;								//scale of the coordinates and of the lengths
+        float es = e*s;
+        float q = sqrtf(nuv);
+        if (!(q > 8.f*es*l))							//nearly aligned points
+          continue;
+        float rq = 1.f/q;
+        float r2 = 0.5f*rq*rq;
+        float a = (nu*f._nv-f._nv*duv)*r2;
+        float b = (nu*f._nv-nu*duv)*r2;
+        float xx = a*a*nu+b*b*f._nv+2*a*b*duv;			//squared radius of the circle through the three points
+        float rx = sqrtf(xx);
+        float ex = es*l2*rq*(1.f+2.f*rx*l*rq);
+        float d2 = f._rho2-xx;
+        float ed2 = 2.f*rx*ex+e*(f._rho2+xx);
+        if (d2 < -ed2)
+        {
+          state[j] = 0;
+          continue;
+        }
+        if (!(d2 > 4.f*ed2))
+          continue;
+        float d = sqrtf(d2);							//distance from the center to the plane of the points
+        vector3f center = u*a + f._v*b + uv*(-d*rq) + f._p1;
+        float ec = ex+ed2/d+d*es*l*rq+e*(s+rho);
+        if (!(h > 4.f*ec))
+          continue;
+        vector3f w(f._middle, center);
+        float cosinus = (f._u%w)*ruh;
+        float sinus = (f._v%(f._u^w))*rvuh;
+        float ea = 2.f*((ec+es)*rh+eun)+e;				//error on the cosine and the sine
+        float cos1 = 1.f+cosinus;
+        if (!(cos1 > 4.f*ea))
+          continue;
+        float rc = 1.f/cos1;
+        float t = sinus*rc;
+        halfTangent[j] = t;
+        error[j] = 2.f*ea*(1.f+fabsf(t))*rc+e*fabsf(t);
+        state[j] = 1;
+      }
+    }
+
+#ifdef SCD_X86_KERNELS
+    //the avx2 target does not enable fma, the products and sums are not contracted
+
+    __attribute__((target("avx2")))
+    inline __m256d dist2Avx2(const double* x, const double* y, const double* z, int i,
+                             __m256d cx, __m256d cy, __m256d cz)
+    {
+      __m256d dx = _mm256_sub_pd(cx, _mm256_loadu_pd(x+i));
+      __m256d dy = _mm256_sub_pd(cy, _mm256_loadu_pd(y+i));
+      __m256d dz = _mm256_sub_pd(cz, _mm256_loadu_pd(z+i));
+      return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+    }
+
+    __attribute__((target("avx2")))
+    double maxDist2Avx2(const double* x, const double* y, const double* z, int n, const vector3d& c, int& arg)
+    {
+      __m256d cx = _mm256_set1_pd(c.x);
+      __m256d cy = _mm256_set1_pd(c.y);
+      __m256d cz = _mm256_set1_pd(c.z);
+      int m = n&~3;
+      double best = -1.;
+      if (m > 0)
+      {
+        __m256d b = dist2Avx2(x, y, z, 0, cx, cy, cz);
+        for (int i=4; i<m; i+=4)
+          b = _mm256_max_pd(b, dist2Avx2(x, y, z, i, cx, cy, cz));
+        __m128d h = _mm_max_pd(_mm256_castpd256_pd128(b), _mm256_extractf128_pd(b, 1));
+        best = _mm_cvtsd_f64(_mm_max_sd(h, _mm_unpackhi_pd(h, h)));
+      }
+      for (int i=m; i<n; ++i)
+        best = std::max(best, dist2(x, y, z, i, c));
+
+      //first position of the maximum
+      for (int i=0; i<m; i+=4)
+      {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(dist2Avx2(x, y, z, i, cx, cy, cz), _mm256_set1_pd(best), _CMP_EQ_OQ));
+        if (mask)
+        {
+          arg = i+__builtin_ctz(mask);
+          return best;
+        }
+      }
+      for (arg=m; arg<n; ++arg)
+      {
+        if (dist2(x, y, z, arg, c) == best)
+          return best;
+      }
+      arg = 0;
+      return best;
+    }
+
+    __attribute__((target("avx2")))
+    int firstBeyondAvx2(const double* x, const double* y, const double* z, int n, const vector3d& c, double d2)
+    {
+      __m256d cx = _mm256_set1_pd(c.x);
+      __m256d cy = _mm256_set1_pd(c.y);
+      __m256d cz = _mm256_set1_pd(c.z);
+      __m256d r = _mm256_set1_pd(d2);
+      int m = n&~3;
+      for (int i=0; i<m; i+=4)
+      {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(dist2Avx2(x, y, z, i, cx, cy, cz), r, _CMP_GT_OQ));
+        if (mask)
+          return i+__builtin_ctz(mask);
+      }
+      for (int i=m; i<n; ++i)
+      {
+        if (dist2(x, y, z, i, c) > d2)
+          return i;
+      }
+      return -1;
+    }
+
+    __attribute__((target("avx2")))
+    void edgeCentersAvx2(const EdgeFrame<double>& f, const double* x, const double* y, const double* z, int n,
+                         double* cx, double* cy, double* cz, double* pseudoAngle, char* valid)
+    {
+      __m256d p1x = _mm256_set1_pd(f._p1.x), p1y = _mm256_set1_pd(f._p1.y), p1z = _mm256_set1_pd(f._p1.z);
+      __m256d vx = _mm256_set1_pd(f._v.x), vy = _mm256_set1_pd(f._v.y), vz = _mm256_set1_pd(f._v.z);
+      __m256d mx = _mm256_set1_pd(f._middle.x), my = _mm256_set1_pd(f._middle.y), mz = _mm256_set1_pd(f._middle.z);
+      __m256d ux0 = _mm256_set1_pd(f._u.x), uy0 = _mm256_set1_pd(f._u.y), uz0 = _mm256_set1_pd(f._u.z);
+      __m256d nv = _mm256_set1_pd(f._nv), rho2 = _mm256_set1_pd(f._rho2), normU = _mm256_set1_pd(f._normU);
+      __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.), two = _mm256_set1_pd(2.);
+      int m = n&~3;
+      for (int j=0; j<m; j+=4)
+      {
+        __m256d ux = _mm256_sub_pd(_mm256_loadu_pd(x+j), p1x);
+        __m256d uy = _mm256_sub_pd(_mm256_loadu_pd(y+j), p1y);
+        __m256d uz = _mm256_sub_pd(_mm256_loadu_pd(z+j), p1z);
+        __m256d duv = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ux, vx), _mm256_mul_pd(uy, vy)), _mm256_mul_pd(uz, vz));
+        __m256d uvx = _mm256_sub_pd(_mm256_mul_pd(uy, vz), _mm256_mul_pd(vy, uz));
+        __m256d uvy = _mm256_sub_pd(_mm256_mul_pd(uz, vx), _mm256_mul_pd(vz, ux));
+        __m256d uvz = _mm256_sub_pd(_mm256_mul_pd(ux, vy), _mm256_mul_pd(vx, uy));
+        __m256d nu = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ux, ux), _mm256_mul_pd(uy, uy)), _mm256_mul_pd(uz, uz));
+        __m256d nuv = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(uvx, uvx), _mm256_mul_pd(uvy, uvy)), _mm256_mul_pd(uvz, uvz));
+        __m256d nuv2 = _mm256_mul_pd(two, nuv);
+        __m256d nunv = _mm256_mul_pd(nu, nv);
+        __m256d a = _mm256_div_pd(_mm256_sub_pd(nunv, _mm256_mul_pd(nv, duv)), nuv2);
+        __m256d b = _mm256_div_pd(_mm256_sub_pd(nunv, _mm256_mul_pd(nu, duv)), nuv2);
+        __m256d t = _mm256_sub_pd(rho2, _mm256_mul_pd(_mm256_mul_pd(a, a), nu));
+        t = _mm256_sub_pd(t, _mm256_mul_pd(_mm256_mul_pd(b, b), nv));
+        t = _mm256_sub_pd(t, _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(two, a), b), duv));
+        t = _mm256_div_pd(t, nuv);
+        int ok = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(nuv, zero, _CMP_NEQ_UQ), _mm256_cmp_pd(t, zero, _CMP_GT_OQ)));
+        for (int k=0; k<4; ++k)
+          valid[j+k] = (ok>>k)&1;
+        if (!ok)
+          continue;
+        __m256d c = _mm256_sub_pd(zero, _mm256_sqrt_pd(t));
+        __m256d ccx = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ux, a), _mm256_mul_pd(vx, b)), _mm256_mul_pd(uvx, c)), p1x);
+        __m256d ccy = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(uy, a), _mm256_mul_pd(vy, b)), _mm256_mul_pd(uvy, c)), p1y);
+        __m256d ccz = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(uz, a), _mm256_mul_pd(vz, b)), _mm256_mul_pd(uvz, c)), p1z);
+        _mm256_storeu_pd(cx+j, ccx);
+        _mm256_storeu_pd(cy+j, ccy);
+        _mm256_storeu_pd(cz+j, ccz);
+
+        __m256d wx = _mm256_sub_pd(ccx, mx), wy = _mm256_sub_pd(ccy, my), wz = _mm256_sub_pd(ccz, mz);
+        __m256d dot = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ux0, wx), _mm256_mul_pd(uy0, wy)), _mm256_mul_pd(uz0, wz));
+        __m256d nw = _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(wx, wx), _mm256_mul_pd(wy, wy)), _mm256_mul_pd(wz, wz)));
+        __m256d cosinus = _mm256_div_pd(dot, _mm256_mul_pd(normU, nw));
+        cosinus = _mm256_min_pd(one, _mm256_max_pd(_mm256_sub_pd(zero, one), cosinus));		//a NaN is kept, as in the scalar code
+        __m256d crx = _mm256_sub_pd(_mm256_mul_pd(uy0, wz), _mm256_mul_pd(wy, uz0));
+        __m256d cry = _mm256_sub_pd(_mm256_mul_pd(uz0, wx), _mm256_mul_pd(wz, ux0));
+        __m256d crz = _mm256_sub_pd(_mm256_mul_pd(ux0, wy), _mm256_mul_pd(wx, uy0));
+        __m256d sign = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx, crx), _mm256_mul_pd(vy, cry)), _mm256_mul_pd(vz, crz));
+        __m256d positive = _mm256_cmp_pd(sign, zero, _CMP_GT_OQ);
+        _mm256_storeu_pd(pseudoAngle+j, _mm256_blendv_pd(_mm256_sub_pd(cosinus, one), _mm256_sub_pd(one, cosinus), positive));
+      }
+      edgeCentersScalar(f, x+m, y+m, z+m, n-m, cx+m, cy+m, cz+m, pseudoAngle+m, valid+m);
+    }
+
+    __attribute__((target("avx2")))
+    void halfTangentsFloatAvx2(const EdgeFrame<float>& f, const float* x, const float* y, const float* z, int n,
+                               float* halfTangent, float* error, char* state)
+    {
+      const float e = floatRoundoff;
+      float hs = sqrtf(f._rho2-f._nv/4);
+      float eu = e*(2.f+f._normU);
+      if (!(hs > 0.f && f._normU > 4.f*eu))
+      {
+        for (int j=0; j<n; ++j)
+          state[j] = 2;
+        return;
+      }
+      __m256 p1x = _mm256_set1_ps(f._p1.x), p1y = _mm256_set1_ps(f._p1.y), p1z = _mm256_set1_ps(f._p1.z);
+      __m256 vx = _mm256_set1_ps(f._v.x), vy = _mm256_set1_ps(f._v.y), vz = _mm256_set1_ps(f._v.z);
+      __m256 mx = _mm256_set1_ps(f._middle.x), my = _mm256_set1_ps(f._middle.y), mz = _mm256_set1_ps(f._middle.z);
+      __m256 ux0 = _mm256_set1_ps(f._u.x), uy0 = _mm256_set1_ps(f._u.y), uz0 = _mm256_set1_ps(f._u.z);
+      __m256 nv = _mm256_set1_ps(f._nv), rho2 = _mm256_set1_ps(f._rho2), rho = _mm256_set1_ps(sqrtf(f._rho2));
+      float ruhs = 1.f/(f._normU*hs);
+      __m256 h = _mm256_set1_ps(hs), rh = _mm256_set1_ps(1.f/hs), ruh = _mm256_set1_ps(ruhs);
+      __m256 rvuh = _mm256_set1_ps(ruhs/sqrtf(f._nv)), eun = _mm256_set1_ps(eu/f._normU);
+      __m256 ev = _mm256_set1_ps(e), zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f), two = _mm256_set1_ps(2.f);
+      __m256 half = _mm256_set1_ps(0.5f), four = _mm256_set1_ps(4.f), eight = _mm256_set1_ps(8.f);
+      __m256 sign = _mm256_set1_ps(-0.f);
+      int m = n&~7;
+      for (int j=0; j<m; j+=8)
+      {
+        __m256 ux = _mm256_sub_ps(_mm256_loadu_ps(x+j), p1x);
+        __m256 uy = _mm256_sub_ps(_mm256_loadu_ps(y+j), p1y);
+        __m256 uz = _mm256_sub_ps(_mm256_loadu_ps(z+j), p1z);
+        __m256 duv = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ux, vx), _mm256_mul_ps(uy, vy)), _mm256_mul_ps(uz, vz));
+        __m256 uvx = _mm256_sub_ps(_mm256_mul_ps(uy, vz), _mm256_mul_ps(vy, uz));
+        __m256 uvy = _mm256_sub_ps(_mm256_mul_ps(uz, vx), _mm256_mul_ps(vz, ux));
+        __m256 uvz = _mm256_sub_ps(_mm256_mul_ps(ux, vy), _mm256_mul_ps(vx, uy));
+        __m256 nu = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ux, ux), _mm256_mul_ps(uy, uy)), _mm256_mul_ps(uz, uz));
+        __m256 nuv = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(uvx, uvx), _mm256_mul_ps(uvy, uvy)), _mm256_mul_ps(uvz, uvz));
+        __m256 l2 = _mm256_add_ps(nu, nv);
+        __m256 l = _mm256_sqrt_ps(l2);
+        __m256 s = _mm256_add_ps(two, l);
+        __m256 es = _mm256_mul_ps(ev, s);
+        __m256 q = _mm256_sqrt_ps(nuv);
+        __m256 ok = _mm256_cmp_ps(q, _mm256_mul_ps(_mm256_mul_ps(eight, es), l), _CMP_GT_OQ);
+        __m256 rq = _mm256_div_ps(one, q);
+        __m256 r2 = _mm256_mul_ps(_mm256_mul_ps(half, rq), rq);
+        __m256 nunv = _mm256_mul_ps(nu, nv);
+        __m256 a = _mm256_mul_ps(_mm256_sub_ps(nunv, _mm256_mul_ps(nv, duv)), r2);
+        __m256 b = _mm256_mul_ps(_mm256_sub_ps(nunv, _mm256_mul_ps(nu, duv)), r2);
+        __m256 xx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(a, a), nu), _mm256_mul_ps(_mm256_mul_ps(b, b), nv)),
+                                  _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(two, a), b), duv));
+        __m256 rx = _mm256_sqrt_ps(xx);
+        __m256 ex = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(es, l2), rq),
+                                  _mm256_add_ps(one, _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(two, rx), l), rq)));
+        __m256 d2 = _mm256_sub_ps(rho2, xx);
+        __m256 ed2 = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, rx), ex), _mm256_mul_ps(ev, _mm256_add_ps(rho2, xx)));
+        int none = _mm256_movemask_ps(_mm256_and_ps(ok, _mm256_cmp_ps(d2, _mm256_sub_ps(zero, ed2), _CMP_LT_OQ)));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(d2, _mm256_mul_ps(four, ed2), _CMP_GT_OQ));
+
+        __m256 d = _mm256_sqrt_ps(d2);
+        __m256 c = _mm256_sub_ps(zero, _mm256_mul_ps(d, rq));
+        __m256 ccx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ux, a), _mm256_mul_ps(vx, b)), _mm256_mul_ps(uvx, c)), p1x);
+        __m256 ccy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(uy, a), _mm256_mul_ps(vy, b)), _mm256_mul_ps(uvy, c)), p1y);
+        __m256 ccz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(uz, a), _mm256_mul_ps(vz, b)), _mm256_mul_ps(uvz, c)), p1z);
+        __m256 ec = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(ex, _mm256_div_ps(ed2, d)), _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(d, es), l), rq)),
+                                  _mm256_mul_ps(ev, _mm256_add_ps(s, rho)));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(h, _mm256_mul_ps(four, ec), _CMP_GT_OQ));
+        __m256 wx = _mm256_sub_ps(ccx, mx), wy = _mm256_sub_ps(ccy, my), wz = _mm256_sub_ps(ccz, mz);
+        __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ux0, wx), _mm256_mul_ps(uy0, wy)), _mm256_mul_ps(uz0, wz));
+        __m256 cosinus = _mm256_mul_ps(dot, ruh);
+        __m256 crx = _mm256_sub_ps(_mm256_mul_ps(uy0, wz), _mm256_mul_ps(wy, uz0));
+        __m256 cry = _mm256_sub_ps(_mm256_mul_ps(uz0, wx), _mm256_mul_ps(wz, ux0));
+        __m256 crz = _mm256_sub_ps(_mm256_mul_ps(ux0, wy), _mm256_mul_ps(wx, uy0));
+        __m256 sinus = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, crx), _mm256_mul_ps(vy, cry)), _mm256_mul_ps(vz, crz)), rvuh);
+        __m256 ea = _mm256_add_ps(_mm256_mul_ps(two, _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(ec, es), rh), eun)), ev);
+        __m256 cos1 = _mm256_add_ps(one, cosinus);
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(cos1, _mm256_mul_ps(four, ea), _CMP_GT_OQ));
+        __m256 rc = _mm256_div_ps(one, cos1);
+        __m256 t = _mm256_mul_ps(sinus, rc);
+        __m256 at = _mm256_andnot_ps(sign, t);
+        __m256 et = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(two, ea), _mm256_add_ps(one, at)), rc), _mm256_mul_ps(ev, at));
+        _mm256_storeu_ps(halfTangent+j, t);
+        _mm256_storeu_ps(error+j, et);
+        int valid = _mm256_movemask_ps(ok);
+        for (int k=0; k<8; ++k)
+          state[j+k] = ((valid>>k)&1)?1:(((none>>k)&1)?0:2);
+      }
+      halfTangentsFloatScalar(f, x+m, y+m, z+m, n-m, halfTangent+m, error+m, state+m);
+    }
+
+    //avx512f enables fma : the explicitly rounded operations are never contracted
+    //and the tails are handled with masked loads rather than scalar code
+#define SCD_ROUND (_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC)
+
+    __attribute__((target("avx512f")))
+    inline __m512d dist2Avx512(const double* x, const double* y, const double* z, int i, __mmask8 k,
+                               __m512d cx, __m512d cy, __m512d cz)
+    {
+      __m512d dx = _mm512_sub_round_pd(cx, _mm512_maskz_loadu_pd(k, x+i), SCD_ROUND);
+      __m512d dy = _mm512_sub_round_pd(cy, _mm512_maskz_loadu_pd(k, y+i), SCD_ROUND);
+      __m512d dz = _mm512_sub_round_pd(cz, _mm512_maskz_loadu_pd(k, z+i), SCD_ROUND);
+      return _mm512_add_round_pd(_mm512_add_round_pd(_mm512_mul_round_pd(dx, dx, SCD_ROUND),
+                                                     _mm512_mul_round_pd(dy, dy, SCD_ROUND), SCD_ROUND),
+                                 _mm512_mul_round_pd(dz, dz, SCD_ROUND), SCD_ROUND);
+    }
+
+    inline __mmask8 lanes(int i, int n)
+    {
+      return (n-i >= 8)?__mmask8(0xff):__mmask8((1<<(n-i))-1);
+    }
+
+    __attribute__((target("avx512f")))
+    double maxDist2Avx512(const double* x, const double* y, const double* z, int n, const vector3d& c, int& arg)
+    {
+      __m512d cx = _mm512_set1_pd(c.x);
+      __m512d cy = _mm512_set1_pd(c.y);
+      __m512d cz = _mm512_set1_pd(c.z);
+      __m512d b = _mm512_set1_pd(-1.);
+      for (int i=0; i<n; i+=8)
+      {
+        __mmask8 k = lanes(i, n);
+        b = _mm512_mask_max_pd(b, k, b, dist2Avx512(x, y, z, i, k, cx, cy, cz));
+      }
+      double best = _mm512_reduce_max_pd(b);
+
+      //first position of the maximum
+      __m512d vb = _mm512_set1_pd(best);
+      for (int i=0; i<n; i+=8)
+      {
+        __mmask8 k = lanes(i, n);
+        __mmask8 eq = _mm512_mask_cmp_pd_mask(k, dist2Avx512(x, y, z, i, k, cx, cy, cz), vb, _CMP_EQ_OQ);
+        if (eq)
+        {
+          arg = i+__builtin_ctz(eq);
+          return best;
+        }
+      }
+      arg = 0;
+      return best;
+    }
+
+    __attribute__((target("avx512f")))
+    int firstBeyondAvx512(const double* x, const double* y, const double* z, int n, const vector3d& c, double d2)
+    {
+      __m512d cx = _mm512_set1_pd(c.x);
+      __m512d cy = _mm512_set1_pd(c.y);
+      __m512d cz = _mm512_set1_pd(c.z);
+      __m512d r = _mm512_set1_pd(d2);
+      for (int i=0; i<n; i+=8)
+      {
+        __mmask8 k = lanes(i, n);
+        __mmask8 gt = _mm512_mask_cmp_pd_mask(k, dist2Avx512(x, y, z, i, k, cx, cy, cz), r, _CMP_GT_OQ);
+        if (gt)
+          return i+__builtin_ctz(gt);
+      }
+      return -1;
+    }
+    __attribute__((target("avx512f")))
+    void edgeCentersAvx512(const EdgeFrame<double>& f, const double* x, const double* y, const double* z, int n,
+                           double* cx, double* cy, double* cz, double* pseudoAngle, char* valid)
+    {
+#define SCD_ADD(a, b) _mm512_add_round_pd(a, b, SCD_ROUND)
+#define SCD_SUB(a, b) _mm512_sub_round_pd(a, b, SCD_ROUND)
+#define SCD_MUL(a, b) _mm512_mul_round_pd(a, b, SCD_ROUND)
+#define SCD_DIV(a, b) _mm512_div_round_pd(a, b, SCD_ROUND)
+      __m512d p1x = _mm512_set1_pd(f._p1.x), p1y = _mm512_set1_pd(f._p1.y), p1z = _mm512_set1_pd(f._p1.z);
+      __m512d vx = _mm512_set1_pd(f._v.x), vy = _mm512_set1_pd(f._v.y), vz = _mm512_set1_pd(f._v.z);
+      __m512d mx = _mm512_set1_pd(f._middle.x), my = _mm512_set1_pd(f._middle.y), mz = _mm512_set1_pd(f._middle.z);
+      __m512d ux0 = _mm512_set1_pd(f._u.x), uy0 = _mm512_set1_pd(f._u.y), uz0 = _mm512_set1_pd(f._u.z);
+      __m512d nv = _mm512_set1_pd(f._nv), rho2 = _mm512_set1_pd(f._rho2), normU = _mm512_set1_pd(f._normU);
+      __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.), two = _mm512_set1_pd(2.);
+      for (int j=0; j<n; j+=8)
+      {
+        __mmask8 k = lanes(j, n);
+        __m512d ux = SCD_SUB(_mm512_maskz_loadu_pd(k, x+j), p1x);
+        __m512d uy = SCD_SUB(_mm512_maskz_loadu_pd(k, y+j), p1y);
+        __m512d uz = SCD_SUB(_mm512_maskz_loadu_pd(k, z+j), p1z);
+        __m512d duv = SCD_ADD(SCD_ADD(SCD_MUL(ux, vx), SCD_MUL(uy, vy)), SCD_MUL(uz, vz));
+        __m512d uvx = SCD_SUB(SCD_MUL(uy, vz), SCD_MUL(vy, uz));
+        __m512d uvy = SCD_SUB(SCD_MUL(uz, vx), SCD_MUL(vz, ux));
+        __m512d uvz = SCD_SUB(SCD_MUL(ux, vy), SCD_MUL(vx, uy));
+        __m512d nu = SCD_ADD(SCD_ADD(SCD_MUL(ux, ux), SCD_MUL(uy, uy)), SCD_MUL(uz, uz));
+        __m512d nuv = SCD_ADD(SCD_ADD(SCD_MUL(uvx, uvx), SCD_MUL(uvy, uvy)), SCD_MUL(uvz, uvz));
+        __m512d nuv2 = SCD_MUL(two, nuv);
+        __m512d nunv = SCD_MUL(nu, nv);
+        __m512d a = SCD_DIV(SCD_SUB(nunv, SCD_MUL(nv, duv)), nuv2);
+        __m512d b = SCD_DIV(SCD_SUB(nunv, SCD_MUL(nu, duv)), nuv2);
+        __m512d t = SCD_SUB(rho2, SCD_MUL(SCD_MUL(a, a), nu));
+        t = SCD_SUB(t, SCD_MUL(SCD_MUL(b, b), nv));
+        t = SCD_SUB(t, SCD_MUL(SCD_MUL(SCD_MUL(two, a), b), duv));
+        t = SCD_DIV(t, nuv);
+        __mmask8 ok = _mm512_mask_cmp_pd_mask(_mm512_mask_cmp_pd_mask(k, nuv, zero, _CMP_NEQ_UQ), t, zero, _CMP_GT_OQ);
+        for (int i=0; i<8 && j+i<n; ++i)
+          valid[j+i] = (ok>>i)&1;
+        if (!ok)
+          continue;
+        __m512d c = SCD_SUB(zero, _mm512_sqrt_round_pd(t, SCD_ROUND));
+        __m512d ccx = SCD_ADD(SCD_ADD(SCD_ADD(SCD_MUL(ux, a), SCD_MUL(vx, b)), SCD_MUL(uvx, c)), p1x);
+        __m512d ccy = SCD_ADD(SCD_ADD(SCD_ADD(SCD_MUL(uy, a), SCD_MUL(vy, b)), SCD_MUL(uvy, c)), p1y);
+        __m512d ccz = SCD_ADD(SCD_ADD(SCD_ADD(SCD_MUL(uz, a), SCD_MUL(vz, b)), SCD_MUL(uvz, c)), p1z);
+        _mm512_mask_storeu_pd(cx+j, k, ccx);
+        _mm512_mask_storeu_pd(cy+j, k, ccy);
+        _mm512_mask_storeu_pd(cz+j, k, ccz);
+
+        __m512d wx = SCD_SUB(ccx, mx), wy = SCD_SUB(ccy, my), wz = SCD_SUB(ccz, mz);
+        __m512d dot = SCD_ADD(SCD_ADD(SCD_MUL(ux0, wx), SCD_MUL(uy0, wy)), SCD_MUL(uz0, wz));
+        __m512d nw = _mm512_sqrt_round_pd(SCD_ADD(SCD_ADD(SCD_MUL(wx, wx), SCD_MUL(wy, wy)), SCD_MUL(wz, wz)), SCD_ROUND);
+        __m512d cosinus = SCD_DIV(dot, SCD_MUL(normU, nw));
+        cosinus = _mm512_min_pd(one, _mm512_max_pd(SCD_SUB(zero, one), cosinus));
+        __m512d crx = SCD_SUB(SCD_MUL(uy0, wz), SCD_MUL(wy, uz0));
+        __m512d cry = SCD_SUB(SCD_MUL(uz0, wx), SCD_MUL(wz, ux0));
+        __m512d crz = SCD_SUB(SCD_MUL(ux0, wy), SCD_MUL(wx, uy0));
+        __m512d sign = SCD_ADD(SCD_ADD(SCD_MUL(vx, crx), SCD_MUL(vy, cry)), SCD_MUL(vz, crz));
+        __mmask8 positive = _mm512_cmp_pd_mask(sign, zero, _CMP_GT_OQ);
+        _mm512_mask_storeu_pd(pseudoAngle+j, k, _mm512_mask_blend_pd(positive, SCD_SUB(cosinus, one), SCD_SUB(one, cosinus)));
+      }
+#undef SCD_ADD
+#undef SCD_SUB
+#undef SCD_MUL
+#undef SCD_DIV
+    }
+    __attribute__((target("avx512f")))
+    void halfTangentsFloatAvx512(const EdgeFrame<float>& f, const float* x, const float* y, const float* z, int n,
+                                 float* halfTangent, float* error, char* state)
+    {
+#define SCD_ADD(a, b) _mm512_add_round_ps(a, b, SCD_ROUND)
+#define SCD_SUB(a, b) _mm512_sub_round_ps(a, b, SCD_ROUND)
+#define SCD_MUL(a, b) _mm512_mul_round_ps(a, b, SCD_ROUND)
+#define SCD_DIV(a, b) _mm512_div_round_ps(a, b, SCD_ROUND)
+#define SCD_SQRT(a) _mm512_sqrt_round_ps(a, SCD_ROUND)
+      const float e = floatRoundoff;
+      float hs = sqrtf(f._rho2-f._nv/4);
+      float eu = e*(2.f+f._normU);
+      if (!(hs > 0.f && f._normU > 4.f*eu))
+      {
+        for (int j=0; j<n; ++j)
+          state[j] = 2;
+        return;
+      }
+      __m512 p1x = _mm512_set1_ps(f._p1.x), p1y = _mm512_set1_ps(f._p1.y), p1z = _mm512_set1_ps(f._p1.z);
+      __m512 vx = _mm512_set1_ps(f._v.x), vy = _mm512_set1_ps(f._v.y), vz = _mm512_set1_ps(f._v.z);
+      __m512 mx = _mm512_set1_ps(f._middle.x), my = _mm512_set1_ps(f._middle.y), mz = _mm512_set1_ps(f._middle.z);
+      __m512 ux0 = _mm512_set1_ps(f._u.x), uy0 = _mm512_set1_ps(f._u.y), uz0 = _mm512_set1_ps(f._u.z);
+      __m512 nv = _mm512_set1_ps(f._nv), rho2 = _mm512_set1_ps(f._rho2), rho = _mm512_set1_ps(sqrtf(f._rho2));
+      float ruhs = 1.f/(f._normU*hs);
+      __m512 h = _mm512_set1_ps(hs), rh = _mm512_set1_ps(1.f/hs), ruh = _mm512_set1_ps(ruhs);
+      __m512 rvuh = _mm512_set1_ps(ruhs/sqrtf(f._nv)), eun = _mm512_set1_ps(eu/f._normU);
+      __m512 ev = _mm512_set1_ps(e), zero = _mm512_setzero_ps(), one = _mm512_set1_ps(1.f), two = _mm512_set1_ps(2.f);
+      __m512 half = _mm512_set1_ps(0.5f), four = _mm512_set1_ps(4.f), eight = _mm512_set1_ps(8.f);
+      for (int j=0; j<n; j+=16)
+      {
+        __mmask16 k = (n-j >= 16)?__mmask16(0xFFFF):__mmask16((1u<<(n-j))-1);
+        __m512 ux = SCD_SUB(_mm512_maskz_loadu_ps(k, x+j), p1x);
+        __m512 uy = SCD_SUB(_mm512_maskz_loadu_ps(k, y+j), p1y);
+        __m512 uz = SCD_SUB(_mm512_maskz_loadu_ps(k, z+j), p1z);
+        __m512 duv = SCD_ADD(SCD_ADD(SCD_MUL(ux, vx), SCD_MUL(uy, vy)), SCD_MUL(uz, vz));
+        __m512 uvx = SCD_SUB(SCD_MUL(uy, vz), SCD_MUL(vy, uz));
+        __m512 uvy = SCD_SUB(SCD_MUL(uz, vx), SCD_MUL(vz, ux));
+        __m512 uvz = SCD_SUB(SCD_MUL(ux, vy), SCD_MUL(vx, uy));
+        __m512 nu = SCD_ADD(SCD_ADD(SCD_MUL(ux, ux), SCD_MUL(uy, uy)), SCD_MUL(uz, uz));
+        __m512 nuv = SCD_ADD(SCD_ADD(SCD_MUL(uvx, uvx), SCD_MUL(uvy, uvy)), SCD_MUL(uvz, uvz));
+        __m512 l2 = SCD_ADD(nu, nv);
+        __m512 l = SCD_SQRT(l2);
+        __m512 s = SCD_ADD(two, l);
+        __m512 es = SCD_MUL(ev, s);
+        __m512 q = SCD_SQRT(nuv);
+        __mmask16 ok = _mm512_mask_cmp_ps_mask(k, q, SCD_MUL(SCD_MUL(eight, es), l), _CMP_GT_OQ);
+        __m512 rq = SCD_DIV(one, q);
+        __m512 r2 = SCD_MUL(SCD_MUL(half, rq), rq);
+        __m512 nunv = SCD_MUL(nu, nv);
+        __m512 a = SCD_MUL(SCD_SUB(nunv, SCD_MUL(nv, duv)), r2);
+        __m512 b = SCD_MUL(SCD_SUB(nunv, SCD_MUL(nu, duv)), r2);
+        __m512 xx = SCD_ADD(SCD_ADD(SCD_MUL(SCD_MUL(a, a), nu), SCD_MUL(SCD_MUL(b, b), nv)), SCD_MUL(SCD_MUL(SCD_MUL(two, a), b), duv));
+        __m512 rx = SCD_SQRT(xx);
+        __m512 ex = SCD_MUL(SCD_MUL(SCD_MUL(es, l2), rq), SCD_ADD(one, SCD_MUL(SCD_MUL(SCD_MUL(two, rx), l), rq)));
+        __m512 d2 = SCD_SUB(rho2, xx);
+        __m512 ed2 = SCD_ADD(SCD_MUL(SCD_MUL(two, rx), ex), SCD_MUL(ev, SCD_ADD(rho2, xx)));
+        __mmask16 none = _mm512_mask_cmp_ps_mask(ok, d2, SCD_SUB(zero, ed2), _CMP_LT_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, d2, SCD_MUL(four, ed2), _CMP_GT_OQ);
+
+        __m512 d = SCD_SQRT(d2);
+        __m512 c = SCD_SUB(zero, SCD_MUL(d, rq));
+        __m512 ccx = SCD_ADD(SCD_ADD(SCD_ADD(SCD_MUL(ux, a), SCD_MUL(vx, b)), SCD_MUL(uvx, c)), p1x);
+        __m512 ccy = SCD_ADD(SCD_ADD(SCD_ADD(SCD_MUL(uy, a), SCD_MUL(vy, b)), SCD_MUL(uvy, c)), p1y);
+        __m512 ccz = SCD_ADD(SCD_ADD(SCD_ADD(SCD_MUL(uz, a), SCD_MUL(vz, b)), SCD_MUL(uvz, c)), p1z);
+        __m512 ec = SCD_ADD(SCD_ADD(SCD_ADD(ex, SCD_DIV(ed2, d)), SCD_MUL(SCD_MUL(SCD_MUL(d, es), l), rq)), SCD_MUL(ev, SCD_ADD(s, rho)));
+        ok = _mm512_mask_cmp_ps_mask(ok, h, SCD_MUL(four, ec), _CMP_GT_OQ);
+        __m512 wx = SCD_SUB(ccx, mx), wy = SCD_SUB(ccy, my), wz = SCD_SUB(ccz, mz);
+        __m512 dot = SCD_ADD(SCD_ADD(SCD_MUL(ux0, wx), SCD_MUL(uy0, wy)), SCD_MUL(uz0, wz));
+        __m512 cosinus = SCD_MUL(dot, ruh);
+        __m512 crx = SCD_SUB(SCD_MUL(uy0, wz), SCD_MUL(wy, uz0));
+        __m512 cry = SCD_SUB(SCD_MUL(uz0, wx), SCD_MUL(wz, ux0));
+        __m512 crz = SCD_SUB(SCD_MUL(ux0, wy), SCD_MUL(wx, uy0));
+        __m512 sinus = SCD_MUL(SCD_ADD(SCD_ADD(SCD_MUL(vx, crx), SCD_MUL(vy, cry)), SCD_MUL(vz, crz)), rvuh);
+        __m512 ea = SCD_ADD(SCD_MUL(two, SCD_ADD(SCD_MUL(SCD_ADD(ec, es), rh), eun)), ev);
+        __m512 cos1 = SCD_ADD(one, cosinus);
+        ok = _mm512_mask_cmp_ps_mask(ok, cos1, SCD_MUL(four, ea), _CMP_GT_OQ);
+        __m512 rc = SCD_DIV(one, cos1);
+        __m512 t = SCD_MUL(sinus, rc);
+        __m512 at = _mm512_abs_ps(t);
+        __m512 et = SCD_ADD(SCD_MUL(SCD_MUL(SCD_MUL(two, ea), SCD_ADD(one, at)), rc), SCD_MUL(ev, at));
+        _mm512_mask_storeu_ps(halfTangent+j, k, t);
+        _mm512_mask_storeu_ps(error+j, k, et);
+        for (int i=0; i<16 && j+i<n; ++i)
+          state[j+i] = ((ok>>i)&1)?1:(((none>>i)&1)?0:2);
+      }
+#undef SCD_ADD
+#undef SCD_SUB
+#undef SCD_MUL
+#undef SCD_DIV
+#undef SCD_SQRT
+    }
+#undef SCD_ROUND
+#endif
+  }
+
+  const SphereKernels& sphereKernels(KernelSet max)
+  {
+    static const SphereKernels scalar = {maxDist2Scalar, firstBeyondScalar, edgeCentersScalar, halfTangentsFloatScalar, "scalar"};
+#ifdef SCD_X86_KERNELS
+    static const SphereKernels avx2 = {maxDist2Avx2, firstBeyondAvx2, edgeCentersAvx2, halfTangentsFloatAvx2, "avx2"};
+    static const SphereKernels avx512 = {maxDist2Avx512, firstBeyondAvx512, edgeCentersAvx512, halfTangentsFloatAvx512, "avx512"};
+    __builtin_cpu_init();
+    if (max >= avx512Kernels && __builtin_cpu_supports("avx512f"))
+      return avx512;
+    if (max >= avx2Kernels && __builtin_cpu_supports("avx2"))
+      return avx2;
+#endif
+    return scalar;
+  }
+
+  namespace
+  {
+    //xorshift64*, the same cases on every platform
+    class caseGenerator
+    {
+    public:
+      caseGenerator():_state(0x9E3779B97F4A7C15ULL)
+      {}
+
+      double uniform(double a, double b)
+      {
+        _state ^= _state >> 12;
+        _state ^= _state << 25;
+        _state ^= _state >> 27;
+        boost::uint64_t r = _state * 0x2545F4914F6CDD1DULL;
+        return a + (b-a)*double(r >> 11)/9007199254740992.;
+      }
+
+      int below(int n)
+      {
+        return std::min(int(uniform(0, n)), n-1);
+      }
+
+    private:
+      boost::uint64_t _state;
+    };
+
+    template <typename T>
+    bool sameBits(const T& a, const T& b)
+    {
+      return std::memcmp(&a, &b, sizeof(T)) == 0;
+    }
+  }
+
+  int compareSphereKernels(const SphereKernels& kernels, int cases, std::ostream& log)
+  {
+    const SphereKernels& scalar = sphereKernels(scalarKernels);
+    caseGenerator g;
+    int mismatches = 0;
+    for (int c=0; c<cases; ++c)
+    {
+      //a cloud in the unit box, at an offset from the aligned start of the arrays, with some duplicates of the
+      //edge ends (no sphere) and radii from below the size of the cloud to much larger
+      int offset = g.below(16);
+      int n = 1 + g.below(100);
+      alignedDoubles x(offset+n), y(offset+n), z(offset+n);
+      alignedFloats xf(offset+n), yf(offset+n), zf(offset+n);
+      for (int j=offset; j<offset+n; ++j)
+      {
+        x[j] = g.uniform(-1, 1);
+        y[j] = g.uniform(-1, 1);
+        z[j] = g.uniform(-1, 1);
+      }
+      int i1 = offset + g.below(n);
+      int i2 = offset + g.below(n);
+      for (int j=offset; j<offset+n; ++j)
+      {
+        if (g.uniform(0, 1) < 0.05)
+        {
+          int k = (g.uniform(0, 1) < 0.5)?i1:i2;
+          x[j] = x[k];
+          y[j] = y[k];
+          z[j] = z[k];
+        }
+        xf[j] = float(x[j]);
+        yf[j] = float(y[j]);
+        zf[j] = float(z[j]);
+      }
+      const double* px = &x[offset];
+      const double* py = &y[offset];
+      const double* pz = &z[offset];
+      vector3d center(g.uniform(-2, 2), g.uniform(-2, 2), g.uniform(-2, 2));
+      double rho = g.uniform(0.5, 20.);
+
+      bool same = true;
+      int arg1, arg2;
+      double d1 = scalar._maxDist2(px, py, pz, n, center, arg1);
+      double d2 = kernels._maxDist2(px, py, pz, n, center, arg2);
+      same = same && sameBits(d1, d2) && arg1 == arg2;
+      double limit = d1*g.uniform(0.5, 1.);
+      same = same && scalar._firstBeyond(px, py, pz, n, center, limit) == kernels._firstBeyond(px, py, pz, n, center, limit);
+
+      //the rotation around [p1,p2] as in computePivot, from a center on its side
+      vector3d p1(x[i1], y[i1], z[i1]), p2(x[i2], y[i2], z[i2]);
+      EdgeFrame<double> f;
+      f._p1 = p1;
+      f._v = p2-p1;
+      f._nv = f._v.normsquared();
+      f._rho2 = rho*rho;
+      f._middle = (p1+p2)/2;
+      f._u = vector3d(f._middle, center);
+      f._normU = f._u.norm();
+      std::vector<double> cx[2], cy[2], cz[2], angle[2];
+      std::vector<char> valid[2];
+      const SphereKernels* sets[2] = {&scalar, &kernels};
+      for (int s=0; s<2; ++s)
+      {
+        cx[s].assign(n, 0.);
+        cy[s].assign(n, 0.);
+        cz[s].assign(n, 0.);
+        angle[s].assign(n, 0.);
+        valid[s].assign(n, 0);
+        sets[s]->_edgeCenters(f, px, py, pz, n, &cx[s][0], &cy[s][0], &cz[s][0], &angle[s][0], &valid[s][0]);
+      }
+      for (int j=0; j<n; ++j)
+      {
+        same = same && valid[0][j] == valid[1][j];
+        if (valid[0][j])
+          same = same && sameBits(cx[0][j], cx[1][j]) && sameBits(cy[0][j], cy[1][j]) &&
+                 sameBits(cz[0][j], cz[1][j]) && sameBits(angle[0][j], angle[1][j]);
+      }
+
+      EdgeFrame<float> ff;
+      ff._p1 = vector3f(xf[i1], yf[i1], zf[i1]);
+      ff._v = vector3f(xf[i2], yf[i2], zf[i2]) - ff._p1;
+      ff._nv = ff._v.normsquared();
+      ff._rho2 = float(f._rho2);
+      ff._middle = (vector3f(xf[i2], yf[i2], zf[i2]) + ff._p1)/2.f;
+      ff._u = vector3f(float(center.x), float(center.y), float(center.z)) - ff._middle;
+      ff._normU = ff._u.norm();
+      std::vector<float> tangent[2], error[2];
+      std::vector<char> state[2];
+      for (int s=0; s<2; ++s)
+      {
+        tangent[s].assign(n, 0.f);
+        error[s].assign(n, 0.f);
+        state[s].assign(n, 0);
+        sets[s]->_halfTangentsFloat(ff, &xf[offset], &yf[offset], &zf[offset], n, &tangent[s][0], &error[s][0], &state[s][0]);
+      }
+      for (int j=0; j<n; ++j)
+      {
+        same = same && state[0][j] == state[1][j];
+        if (state[0][j] == 1)
+          same = same && sameBits(tangent[0][j], tangent[1][j]) && sameBits(error[0][j], error[1][j]);
+      }
+
+      if (!same)
+      {
+        log << "kernels " << kernels._name << " differ from the scalar ones on the case " << c << std::endl;
+        ++mismatches;
+      }
+    }
+    return mismatches;
+  }
+}
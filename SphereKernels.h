@@ -0,0 +1,94 @@
+/*! \file SphereKernels.h
+ *  \brief Declaration file of the sphere inclusion kernels
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_SPHERE_KERNELS_H
+#define SCD_SPHERE_KERNELS_H
+
+#include <vector>
+#include <iostream>
+#include <boost/align/aligned_allocator.hpp>
+
+#include "vector3.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+  typedef vector3<float> vector3f;
+
+  /// Coordinates of a points cloud stored by component (structure of arrays), aligned for the SIMD loads
+  typedef std::vector<double, boost::alignment::aligned_allocator<double, 64> > alignedDoubles;
+  typedef std::vector<float, boost::alignment::aligned_allocator<float, 64> > alignedFloats;
+
+  /// Relative rounding error assumed for the float kernels, with a wide margin (64 units in the last place)
+  const float floatRoundoff = 64.f/16777216.f;
+
+  /*! \struct EdgeFrame
+   *	\brief %Struct EdgeFrame
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Terms of the sphere centers and of the rotation angles around an edge [p1,p2] that do not
+   * depend on the candidate point
+   */
+  template <typename T>
+  struct EdgeFrame
+  {
+    vector3<T>	_p1;
+    vector3<T>	_v;				//p2-p1, also the rotation axis
+    T			_nv;			//squared norm of _v
+    T			_rho2;			//squared radius of the spheres, (R-r)^2
+    vector3<T>	_middle;		//middle of the edge
+    vector3<T>	_u;				//from the middle of the edge to the center the rotation starts from
+    T			_normU;
+  };
+
+  /*! \struct SphereKernels
+   *	\brief %Struct SphereKernels
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Batched computations on n points given by their coordinates x, y, z.
+   * They follow the operations of the vector3d code they replace (no fused multiply-add),
+   * so every implementation gives exactly the same results as the scalar one.
+   */
+  struct SphereKernels
+  {
+    //largest squared distance from c, and the first position arg reaching it (n > 0)
+    double		(*_maxDist2)(const double* x, const double* y, const double* z, int n, const vector3d& c, int& arg);
+    //first position whose squared distance from c is greater than dist2, -1 if there is none
+    int			(*_firstBeyond)(const double* x, const double* y, const double* z, int n, const vector3d& c, double dist2);
+    //for each point j, the center of the sphere through p1, j and p2 (as findCenter(p1, j, p2)) and a pseudo
+    //angle of the rotation around the edge, monotone with computeAngle : s(1-cos) where s is the sign of the
+    //angle. valid[j] is 0 if there is no such sphere
+    void		(*_edgeCenters)(const EdgeFrame<double>& f, const double* x, const double* y, const double* z, int n,
+                            double* cx, double* cy, double* cz, double* pseudoAngle, char* valid);
+    //float version of _edgeCenters on a cloud normalized to the unit box [-1,1]^3, giving the tangent of the half
+    //angle instead (monotone with it, and well conditioned for the small angles) and a bound of its error from the
+    //exact value. state[j] is 0 if there is no sphere, 1 if there is one, 2 if the float computation is too close
+    //to a limit case to decide
+    void		(*_halfTangentsFloat)(const EdgeFrame<float>& f, const float* x, const float* y, const float* z, int n,
+                                  float* halfTangent, float* error, char* state);
+    const char*	_name;
+  };
+
+  enum KernelSet
+  {
+    scalarKernels,
+    avx2Kernels,
+    avx512Kernels
+  };
+
+  //the best kernels supported by the processor, not above the given set
+  const SphereKernels& sphereKernels(KernelSet max = avx512Kernels);
+  //run the kernels and the scalar ones on the same random cases and compare their results bit for bit, the
+  //mismatches being written to log. Returns the number of cases with a mismatch
+  int compareSphereKernels(const SphereKernels& kernels, int cases, std::ostream& log);
+}
+
+#endif	//SCD_SPHERE_KERNELS_H
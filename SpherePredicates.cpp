@@ -0,0 +1,580 @@
+#include "SpherePredicates.h"
+#include <algorithm>
+#include <limits>
+
+namespace SCD
+{
+  namespace
+  {
+    const double roundoff = std::numeric_limits<double>::epsilon()/2;
+
+    //a double value and a bound of its distance to the exact one. The rounding errors of the bound itself
+    //are covered by a relative margin when its sign is taken
+    struct Bounded
+    {
+      double	_v;
+      double	_e;
+      Bounded(double v = 0.): _v(v), _e(0.) {}
+      Bounded(double v, double e): _v(v), _e(e) {}
+    };
+
+    inline Bounded operator+(const Bounded& a, const Bounded& b)
+    {
+      double v = a._v+b._v;
+      return Bounded(v, a._e+b._e+roundoff*fabs(v));
+    }
+
+    inline Bounded operator-(const Bounded& a, const Bounded& b)
+    {
+      double v = a._v-b._v;
+      return Bounded(v, a._e+b._e+roundoff*fabs(v));
+    }
+
+    inline Bounded operator-(const Bounded& a)
+    {
+      return Bounded(-a._v, a._e);
+    }
+
+    inline Bounded operator*(const Bounded& a, const Bounded& b)
+    {
+      double v = a._v*b._v;
+      //the product of two non zero values may underflow
+      double tiny = (a._v == 0. || b._v == 0.)?0.:std::numeric_limits<double>::min();
+      return Bounded(v, fabs(a._v)*b._e+fabs(b._v)*a._e+a._e*b._e+roundoff*fabs(v)+tiny);
+    }
+
+    inline Bounded operator/(const Bounded& a, const Bounded& b)
+    {
+      double v = a._v/b._v;
+      if (!(fabs(b._v) > b._e))
+        return Bounded(v, std::numeric_limits<double>::infinity());
+      return Bounded(v, (a._e+fabs(v)*b._e)/(fabs(b._v)-b._e)+roundoff*fabs(v)+std::numeric_limits<double>::min());
+    }
+
+    //square root of a value known to be positive
+    inline Bounded boundedSqrt(const Bounded& a)
+    {
+      double v = sqrt(std::max(a._v, 0.));
+      double e = sqrt(a._e);
+      if (v > 0.)
+        e = std::min(e, a._e/v);
+      return Bounded(v, e+roundoff*v);
+    }
+
+    inline bool sign(const Bounded& a, int& s)
+    {
+      const double guard = 1.+1e-12;
+      if (a._v > a._e*guard)
+        s = 1;
+      else if (a._v < -a._e*guard)
+        s = -1;
+      else if (a._v == 0. && a._e == 0.)
+        s = 0;
+      else
+        return false;
+      return true;
+    }
+
+    //an exact value as a sum of non overlapping doubles, by increasing magnitude and without zeros
+    //(the expansions of J. R. Shewchuk, Adaptive Precision Floating-Point Arithmetic and Fast Robust
+    //Geometric Predicates, 1997). The operations must not be contracted into fused multiply-adds.
+    //The components are kept on the stack while they fit, which they do once compressed unless the
+    //coordinates span very different magnitudes
+    class Expansion
+    {
+    public:
+      static const int fixedSize = 32;
+
+      Expansion(): _n(0), _c(_fixed) {}
+      Expansion(double a): _n(a != 0.), _c(_fixed)
+      {
+        _fixed[0] = a;
+      }
+      Expansion(const Expansion& e): _n(0), _c(_fixed)
+      {
+        *this = e;
+      }
+      Expansion& operator=(const Expansion& e)
+      {
+        if (this != &e)
+          std::copy(e._c, e._c+e._n, reserve(e._n));
+        _n = e._n;
+        return *this;
+      }
+
+      int size() const {return _n;}
+      const double* begin() const {return _c;}
+      double* begin() {return _c;}
+      //room for n components, the current ones being lost
+      double* reserve(int n)
+      {
+        if (n <= fixedSize)
+          _c = _fixed;
+        else
+        {
+          if (int(_large.size()) < n)
+            _large.resize(n);
+          _c = &_large[0];
+        }
+        return _c;
+      }
+      void setSize(int n) {_n = n;}
+
+    private:
+      int					_n;
+      double*				_c;
+      double				_fixed[fixedSize];
+      std::vector<double>	_large;
+    };
+
+    //x+y = a+b exactly, x being the rounded sum
+    inline void twoSum(double a, double b, double& x, double& y)
+    {
+      x = a+b;
+      double bv = x-a;
+      double av = x-bv;
+      y = (a-av)+(b-bv);
+    }
+
+    //the same knowing that |a| >= |b|
+    inline void fastTwoSum(double a, double b, double& x, double& y)
+    {
+      x = a+b;
+      y = b-(x-a);
+    }
+
+    inline void split(double a, double& hi, double& lo)
+    {
+      double c = 134217729.*a;		//2^27+1
+      hi = c-(c-a);
+      lo = a-hi;
+    }
+
+    //x+y = a.b exactly, x being the rounded product
+    inline void twoProduct(double a, double b, double& x, double& y)
+    {
+      x = a*b;
+      double ah, al, bh, bl;
+      split(a, ah, al);
+      split(b, bh, bl);
+      y = al*bl-(((x-ah*bh)-al*bh)-ah*bl);
+    }
+
+    //h = e+f (fast_expansion_sum_zeroelim), e and f being strongly non overlapping. Returns the length of h
+    int sum(const double* e, int m, const double* f, int n, double* h)
+    {
+      if (m == 0 || n == 0)
+      {
+        std::copy(f, f+n, std::copy(e, e+m, h));
+        return m+n;
+      }
+      //the components of e and f are merged by increasing magnitude
+      int i = 0, k = 0, l = 0;
+      double q, t, next;
+      if ((f[0] > e[0]) == (f[0] > -e[0]))
+        q = e[i++];
+      else
+        q = f[k++];
+      if (i < m && k < n)
+      {
+        if ((f[k] > e[i]) == (f[k] > -e[i]))
+          next = e[i++];
+        else
+          next = f[k++];
+        fastTwoSum(next, q, q, t);
+        if (t != 0.)
+          h[l++] = t;
+        while (i < m && k < n)
+        {
+          if ((f[k] > e[i]) == (f[k] > -e[i]))
+            next = e[i++];
+          else
+            next = f[k++];
+          twoSum(q, next, q, t);
+          if (t != 0.)
+            h[l++] = t;
+        }
+      }
+      for (; i<m; ++i)
+      {
+        twoSum(q, e[i], q, t);
+        if (t != 0.)
+          h[l++] = t;
+      }
+      for (; k<n; ++k)
+      {
+        twoSum(q, f[k], q, t);
+        if (t != 0.)
+          h[l++] = t;
+      }
+      if (q != 0.)
+        h[l++] = q;
+      return l;
+    }
+
+    //h = e.b (scale_expansion_zeroelim). Returns the length of h, at most 2m
+    int scale(const double* e, int m, double b, double* h)
+    {
+      if (m == 0 || b == 0.)
+        return 0;
+      int l = 0;
+      double q, t;
+      twoProduct(e[0], b, q, t);
+      if (t != 0.)
+        h[l++] = t;
+      for (int i=1; i<m; ++i)
+      {
+        double p1, p0, s;
+        twoProduct(e[i], b, p1, p0);
+        twoSum(q, p0, s, t);
+        if (t != 0.)
+          h[l++] = t;
+        fastTwoSum(p1, s, q, t);
+        if (t != 0.)
+          h[l++] = t;
+      }
+      if (q != 0.)
+        h[l++] = q;
+      return l;
+    }
+
+    //the same value in place in as few components as possible (compress), they become non adjacent.
+    //Returns the new length
+    int compress(double* e, int n)
+    {
+      if (n < 2)
+        return n;
+      int bottom = n-1;
+      double q = e[bottom];
+      for (int i=n-2; i>=0; --i)
+      {
+        double x, y;
+        fastTwoSum(q, e[i], x, y);
+        if (y != 0.)
+        {
+          e[bottom--] = x;
+          q = y;
+        }
+        else
+          q = x;
+      }
+      int top = 0;
+      for (int i=bottom+1; i<n; ++i)
+      {
+        double x, y;
+        fastTwoSum(e[i], q, x, y);
+        if (y != 0.)
+          e[top++] = y;
+        q = x;
+      }
+      e[top++] = q;
+      return top;
+    }
+
+    Expansion operator+(const Expansion& e, const Expansion& f)
+    {
+      Expansion r;
+      double* h = r.reserve(e.size()+f.size());
+      r.setSize(compress(h, sum(e.begin(), e.size(), f.begin(), f.size(), h)));
+      return r;
+    }
+
+    Expansion operator-(const Expansion& e)
+    {
+      Expansion r(e);
+      double* c = r.begin();
+      for (int i=0; i<r.size(); ++i)
+        c[i] = -c[i];
+      return r;
+    }
+
+    Expansion operator-(const Expansion& e, const Expansion& f)
+    {
+      return e+(-f);
+    }
+
+    //the products of the longer expansion by the components of the other are accumulated
+    Expansion operator*(const Expansion& e, const Expansion& f)
+    {
+      const Expansion& a = (e.size() < f.size())?f:e;
+      const Expansion& b = (e.size() < f.size())?e:f;
+      Expansion r, t, u;
+      if (b.size() == 0)
+        return r;
+      r.setSize(scale(a.begin(), a.size(), b.begin()[0], r.reserve(2*a.size())));
+      for (int i=1; i<b.size(); ++i)
+      {
+        t.setSize(scale(a.begin(), a.size(), b.begin()[i], t.reserve(2*a.size())));
+        double* h = u.reserve(r.size()+t.size());
+        u.setSize(compress(h, sum(r.begin(), r.size(), t.begin(), t.size(), h)));
+        std::swap(r, u);
+      }
+      r.setSize(compress(r.begin(), r.size()));
+      return r;
+    }
+
+    inline bool sign(const Expansion& a, int& s)
+    {
+      s = (a.size() == 0)?0:((a.begin()[a.size()-1] > 0.)?1:-1);
+      return true;
+    }
+
+    //the largest components of an expansion, and a bound of the sum of the ones dropped along the
+    //computation. The intermediate stage between Bounded and Expansion : the values of the predicates
+    //on nearly cospherical points are too small for the precision of a double, but rarely for the one
+    //of two components
+    struct Truncated
+    {
+      static const int length = 2;
+
+      int		_n;
+      double	_c[length];
+      double	_e;
+      Truncated(double a = 0.): _n(a != 0.), _e(0.)
+      {
+        _c[0] = a;
+      }
+      //the exact value h of n components (compressed in place) plus the error e
+      Truncated(double* h, int n, double e): _e(e)
+      {
+        n = compress(h, n);
+        _n = (n < length)?n:length;
+        for (int i=0; i<n-_n; ++i)
+          _e += fabs(h[i]);
+        std::copy(h+n-_n, h+n, _c);
+      }
+      double magnitude() const
+      {
+        double m = 0.;
+        for (int i=0; i<_n; ++i)
+          m += fabs(_c[i]);
+        return m;
+      }
+    };
+
+    inline Truncated operator+(const Truncated& a, const Truncated& b)
+    {
+      double h[2*Truncated::length];
+      return Truncated(h, sum(a._c, a._n, b._c, b._n, h), a._e+b._e);
+    }
+
+    inline Truncated operator-(const Truncated& a)
+    {
+      Truncated r(a);
+      for (int i=0; i<r._n; ++i)
+        r._c[i] = -r._c[i];
+      return r;
+    }
+
+    inline Truncated operator-(const Truncated& a, const Truncated& b)
+    {
+      return a+(-b);
+    }
+
+    inline Truncated operator*(const Truncated& a, const Truncated& b)
+    {
+      double h[2][2*Truncated::length*Truncated::length];
+      double t[2*Truncated::length];
+      int n = 0, k = 0;
+      for (int i=0; i<b._n; ++i)
+      {
+        int m = scale(a._c, a._n, b._c[i], t);
+        n = sum(h[k], n, t, m, h[1-k]);
+        k = 1-k;
+      }
+      //the product of two non zero values may underflow
+      double tiny = (a._n == 0 || b._n == 0)?0.:std::numeric_limits<double>::min();
+      return Truncated(h[k], n, a.magnitude()*b._e+b.magnitude()*a._e+a._e*b._e+tiny);
+    }
+
+    inline bool sign(const Truncated& a, int& s)
+    {
+      //the largest component of a compressed expansion is its value up to a relative 2^-52
+      const double guard = 1.+1e-12;
+      double v = (a._n == 0)?0.:a._c[a._n-1];
+      if (fabs(v)*(1.-1e-15) > a._e*guard)
+        s = (v > 0.)?1:-1;
+      else if (a._n == 0 && a._e == 0.)
+        s = 0;
+      else
+        return false;
+      return true;
+    }
+
+    //sign of A+B.sqrt(K/N), with K and N positive. False if T is not precise enough to decide
+    template <typename T>
+    bool signOfSum(const T& A, const T& B, const T& K, const T& N, int& s)
+    {
+      int sa, sb;
+      if (!sign(A, sa) || !sign(B, sb))
+        return false;
+      if (sb == 0 || sa == sb)
+      {
+        s = sa;
+        return true;
+      }
+      if (sa == 0)
+      {
+        s = sb;
+        return true;
+      }
+      int sd;
+      if (!sign(N*A*A-B*B*K, sd))
+        return false;
+      s = (sd > 0)?sa:((sd < 0)?sb:0);
+      return true;
+    }
+
+    template <typename T>
+    vector3<T> point(const vector3d& p)
+    {
+      return vector3<T>(T(p.x), T(p.y), T(p.z));
+    }
+
+    //the terms of the sphere of the face [a,b,d] : with u = b-a, v = d-a and n = u^v, its center is
+    //a+(X-sqrt(K/N).n)/2N, where N = n.n, X = (|u|^2.v-|v|^2.u)^n is 2N times the vector from a to the
+    //center of the circle through the points and K = 4N^2.rho^2-X.X (the sphere exists if K > 0)
+    template <typename T>
+    struct Face
+    {
+      vector3<T>	_a;
+      vector3<T>	_u;
+      vector3<T>	_v;
+      vector3<T>	_n;
+      vector3<T>	_X;
+      T				_N;
+      T				_K;
+      Face() {}
+      Face(const vector3d& a, const vector3d& b, const vector3d& d, double rho):
+        _a(point<T>(a))
+      {
+        _u = point<T>(b)-_a;
+        _v = point<T>(d)-_a;
+        _n = _u^_v;
+        _N = _n%_n;
+        _X = (_v*(_u%_u)-_u*(_v%_v))^_n;
+        _K = _N*_N*T(4.)*(T(rho)*T(rho))-_X%_X;
+      }
+    };
+
+    //sign of the squared distance from p to the center of the sphere of the face [a,b,d] minus rho^2,
+    //with the perturbation of the points of the given indices. False if T is not precise enough to decide
+    template <typename T>
+    bool sphereSide(const Face<T>& f, const vector3d& p, const int index[4], int& s)
+    {
+      vector3<T> w = point<T>(p)-f._a;
+      //N(|p-c|^2-rho^2) = P+D.sqrt(K/N)
+      T D = w%f._n;
+      T P = f._N*(w%w)-w%f._X;
+      if (!signOfSum(P, D, f._K, f._N, s))
+        return false;
+      if (s != 0)
+        return true;
+
+      //p is on the sphere. The perturbation moves the center c by dc such that 2(c-q).dc = dq for the
+      //vertices q of the face, and p is out of the sphere if 2(c-p).dc > dp. Writing c-p = sum(l_q.(c-q)),
+      //the sign is the one of sum(l_q.dq)-dp, given by the largest perturbation (the smallest index) whose
+      //coefficient is not zero. The coefficients l_q are ratios of determinants, 2N times the numerators
+      //are A+B.sqrt(K/N) and the denominator det[c-a,c-b,c-d] is negative
+      vector3<T> g = f._n+(f._v^w)+(w^f._u);
+      vector3<T> wv = w^f._v;
+      vector3<T> uw = f._u^w;
+      T A[3] = {f._X%g-f._N*D*T(2.), f._X%wv, f._X%uw};
+      T B[3] = {-(f._n%g), -(f._n%wv), -(f._n%uw)};
+      int order[4] = {0, 1, 2, 3};
+      for (int i=1; i<4; ++i)
+      {
+        for (int k=i; k>0 && index[order[k]] < index[order[k-1]]; --k)
+          std::swap(order[k], order[k-1]);
+      }
+      for (int i=0; i<4; ++i)
+      {
+        int m = order[i];
+        if (m == 3)
+        {
+          s = -1;
+          return true;
+        }
+        int sl;
+        if (!signOfSum(A[m], B[m], f._K, f._N, sl))
+          return false;
+        if (sl != 0)
+        {
+          s = -sl;
+          return true;
+        }
+      }
+      return true;
+    }
+  }
+
+  SpherePredicates::SpherePredicates(const std::vector<vector3d>& points, double rho):
+    _points(points),
+    _rho(rho)
+  {
+  }
+
+  void SpherePredicates::setRadius(double rho)
+  {
+    _rho = rho;
+  }
+
+  bool SpherePredicates::center(int a, int b, int d, vector3d& c, double& error) const
+  {
+    Face<Bounded> f(_points[a], _points[b], _points[d], _rho);
+    int sn, sk;
+    if (!sign(f._N, sn) || !sign(f._K, sk))
+    {
+      Face<Expansion> e(_points[a], _points[b], _points[d], _rho);
+      sign(e._N, sn);
+      sign(e._K, sk);
+    }
+    if (sn <= 0 || sk <= 0)
+      return false;
+
+    Bounded s = boundedSqrt(f._K/f._N);
+    Bounded twoN = f._N*Bounded(2.);
+    vector3<Bounded> cb = f._a+(f._X-f._n*s)/twoN;
+    c = vector3d(cb.x._v, cb.y._v, cb.z._v);
+    error = sqrt(cb.x._e*cb.x._e+cb.y._e*cb.y._e+cb.z._e*cb.z._e)*(1.+1e-12);
+    return true;
+  }
+
+  int SpherePredicates::side(int a, int b, int d, int p) const
+  {
+    const int index[4] = {a, b, d, p};
+    int s;
+    if (!sphereSide(Face<Bounded>(_points[a], _points[b], _points[d], _rho), _points[p], index, s) &&
+        !sphereSide(Face<Truncated>(_points[a], _points[b], _points[d], _rho), _points[p], index, s))
+      sphereSide(Face<Expansion>(_points[a], _points[b], _points[d], _rho), _points[p], index, s);
+    return s;
+  }
+
+  int SpherePredicates::outside(int a, int b, int d, const std::vector<int>& points) const
+  {
+    Face<Bounded> f(_points[a], _points[b], _points[d], _rho);
+    Face<Truncated> t;
+    bool truncated = false;
+    for (unsigned int i=0; i<points.size(); ++i)
+    {
+      int p = points[i];
+      if (p == a || p == b || p == d)
+        continue;
+      const int index[4] = {a, b, d, p};
+      int s;
+      if (!sphereSide(f, _points[p], index, s))
+      {
+        if (!truncated)
+        {
+          t = Face<Truncated>(_points[a], _points[b], _points[d], _rho);
+          truncated = true;
+        }
+        if (!sphereSide(t, _points[p], index, s))
+          sphereSide(Face<Expansion>(_points[a], _points[b], _points[d], _rho), _points[p], index, s);
+      }
+      if (s > 0)
+        return p;
+    }
+    return -1;
+  }
+}
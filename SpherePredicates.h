@@ -0,0 +1,57 @@
+/*! \file SpherePredicates.h
+ *  \brief Declaration file of the Class SpherePredicates
+ *  \version 0.0.0
+ */
+
+#pragma once
+
+#ifndef SCD_SPHERE_PREDICATES_H
+#define SCD_SPHERE_PREDICATES_H
+
+#include <vector>
+
+#include "vector3.h"
+
+namespace SCD
+{
+  typedef vector3<double> vector3d;
+
+  /*! \class SpherePredicates
+   *	\brief %Class SpherePredicates
+   *	\version 0.0.0
+   *	\bug None
+   *	\warning None
+   *
+   * Exact tests on the spheres of radius rho through three points of a cloud, the sphere of the
+   * face [a,b,d] being the one of findCenter(a,b,d). They are first evaluated in double with a bound
+   * of the rounding errors, then with the two largest components of floating point expansions and a
+   * bound of the others, and exactly (with whole expansions) only when neither bound can decide.
+   * The points lying on a sphere are decided by a symbolic perturbation : the squared radius around
+   * the point i is rho^2+e.w^i, with e infinitely smaller than any power of w. Every point is then
+   * either inside or outside, and a single sphere contains all the points around an edge of the STP-BV.
+   * The coordinates are assumed far from the overflow and the underflow.
+   */
+  class SpherePredicates
+  {
+  public:
+    SpherePredicates(const std::vector<vector3d>& points, double rho);
+
+  public:
+    void	setRadius(double rho);
+    //false if there is no sphere through the points a, b, d. Otherwise its center, as computed in double,
+    //and a bound of its distance to the exact one
+    bool	center(int a, int b, int d, vector3d& c, double& error) const;
+    //-1 if the point p (not a vertex of the face) is inside the sphere of the face [a,b,d], 1 if it is
+    //outside. The sphere must exist
+    int		side(int a, int b, int d, int p) const;
+    //the first of the points outside the sphere of the face [a,b,d], -1 if there is none. The vertices of the
+    //face are skipped. The terms of the sphere are computed once for all the points
+    int		outside(int a, int b, int d, const std::vector<int>& points) const;
+
+  private:
+    const std::vector<vector3d>&	_points;
+    double							_rho;
+  };
+}
+
+#endif	//SCD_SPHERE_PREDICATES_H
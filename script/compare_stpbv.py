@@ -0,0 +1,81 @@
+#!/usr/bin/env python
+
+# Compares two STP-BV text files up to the order of their patches : the same
+# spheres and tori, with the same limits, whatever the ids of the patches.
+
+
+def key(values, digits=9):
+  # -0 and 0 are the same value
+  return tuple(round(v, digits) + 0. for v in values)
+
+
+def oriented(values):
+  "the vector or its opposite, the first non zero component being positive."
+  for v in key(values):
+    if v != 0.:
+      return key(values) if v > 0. else key([-x for x in values])
+  return key(values)
+
+
+class STPBV(object):
+  def __init__(self):
+    self._radii = ()
+    self._small = []
+    self._big = []
+    self._tori = []
+
+  def load(self, file):
+    data = file.read().split()
+    pos = [0]
+
+    def take(n):
+      values = [float(x) for x in data[pos[0]:pos[0] + n]]
+      pos[0] += n
+      return values
+
+    def cones(n):
+      # the id of the neighbour patch is dropped, only the limit is kept
+      return tuple(sorted(key(take(5)[1:]) for i in range(n)))
+
+    def planes(n):
+      return tuple(sorted(key(take(4)[1:]) for i in range(n)))
+
+    self._radii = key(take(2))
+    for i in range(int(take(1)[0])):
+      sphere = key(take(4))
+      self._small.append((sphere, cones(int(take(1)[0]))))
+    for i in range(int(take(1)[0])):
+      sphere = key(take(4))
+      vertices = tuple(sorted(key(take(3)) for k in range(3)))
+      self._big.append((sphere, vertices, planes(3)))
+    for i in range(int(take(1)[0])):
+      used = take(1)
+      torus = take(8)
+      # the orientation of the torus depends on the edge it was built from
+      self._tori.append((key(used + torus[:5]), oriented(torus[5:]), cones(2), planes(2)))
+    self._small.sort()
+    self._big.sort()
+    self._tori.sort()
+    return pos[0] == len(data)
+
+  def __eq__(self, other):
+    return ((self._radii, self._small, self._big, self._tori) ==
+            (other._radii, other._small, other._big, other._tori))
+
+if __name__ == '__main__':
+  import sys
+
+  if len(sys.argv) != 3:
+    print('Usage : %s a.txt b.txt' % sys.argv[0])
+    sys.exit(1)
+
+  stpbv = [STPBV(), STPBV()]
+  for s, name in zip(stpbv, sys.argv[1:]):
+    with open(name, 'r') as f:
+      if not s.load(f):
+        print('%s is not an STP-BV' % name)
+        sys.exit(1)
+
+  if not stpbv[0] == stpbv[1]:
+    print('%s and %s differ' % (sys.argv[1], sys.argv[2]))
+    sys.exit(1)
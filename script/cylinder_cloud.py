@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+
+import math
+
+
+def cylinder(rings, n, radius=1., height=1.):
+  "rings of n points on a cylinder, as the vertices of a CAD mesh : the points of each ring are cocircular."
+  points = []
+  for k in range(rings):
+    z = height * k / max(rings - 1, 1)
+    for i in range(n):
+      theta = 2. * math.pi * i / n
+      points.append([radius * math.cos(theta), radius * math.sin(theta), z])
+  return points
+
+
+def save(points, file):
+  file.write('3 \n')
+  file.write('%s\n' % len(points))
+  data = ['%r %r %r\n' % (p[0], p[1], p[2]) for p in points]
+  file.write(''.join(data))
+
+if __name__ == '__main__':
+  import sys
+
+  if len(sys.argv) not in (4, 6):
+    print('Usage : %s out.cloud rings points_per_ring [radius height]' % sys.argv[0])
+    sys.exit(1)
+
+  radius, height = (float(sys.argv[4]), float(sys.argv[5])) if len(sys.argv) == 6 else (1., 1.)
+  with open(sys.argv[1], 'w') as f:
+    save(cylinder(int(sys.argv[2]), int(sys.argv[3]), radius, height), f)
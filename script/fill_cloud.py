@@ -0,0 +1,56 @@
+#!/usr/bin/env python
+
+import random
+
+
+class Cloud(object):
+  def __init__(self, points):
+    self._points = points
+
+  def load(self, file):
+    # File format :
+    # dimension \n number of points \n points coordinates
+    data = file.read().split()
+    n = int(data[1])
+    self._points = [[float(x) for x in data[2 + 3 * i:5 + 3 * i]] for i in range(n)]
+
+  def fill(self, n, seed=0, replace=False):
+    "insert n random points strictly inside the convex hull of the cloud before its points, or replace the cloud by them."
+    rand = random.Random(seed)
+    m = len(self._points)
+    centroid = [sum(p[k] for p in self._points) / m for k in range(3)]
+    points = []
+    for i in range(n):
+      # convex combination of some points, moved towards the centroid
+      w = [rand.random() + 1e-3 for j in range(4)]
+      s = 0.9 / sum(w)
+      q = [self._points[rand.randrange(m)] for j in range(4)]
+      points.append([0.1 * c + s * (w[0] * a + w[1] * b + w[2] * d + w[3] * e)
+                     for c, a, b, d, e in zip(centroid, q[0], q[1], q[2], q[3])])
+    if replace:
+      self._points = points
+    else:
+      # the points of the hull get large indices
+      self._points = points + self._points
+
+  def save(self, file):
+    file.write('3 \n')
+    file.write('%s\n' % len(self._points))
+    data = ['%r %r %r\n' % (p[0], p[1], p[2]) for p in self._points]
+    file.write(''.join(data))
+
+if __name__ == '__main__':
+  import sys
+
+  if len(sys.argv) not in (4, 5) or (len(sys.argv) == 5 and sys.argv[4] != '--only-new'):
+    print('Usage : %s in.cloud out.cloud number_of_points [--only-new]' % sys.argv[0])
+    sys.exit(1)
+
+  cloud = Cloud([])
+  with open(sys.argv[1], 'r') as f:
+    cloud.load(f)
+
+  cloud.fill(int(sys.argv[3]), replace=(len(sys.argv) == 5))
+
+  with open(sys.argv[2], 'w') as f:
+    cloud.save(f)
@@ -0,0 +1,45 @@
+#!/usr/bin/env python
+
+import random
+
+
+def jitter(points, distance, seed=0):
+  "a copy of each distinct point moved by less than distance, after all the points : each copy is welded to its point."
+  rand = random.Random(seed)
+  distinct = []
+  seen = set()
+  for p in points:
+    if tuple(p) not in seen:
+      seen.add(tuple(p))
+      distinct.append(p)
+  # the moves are at most distance/2 along each axis, sqrt(3)/2 distance in norm. As many points are merged
+  # as the cloud has : its exact duplicates and the copies
+  copies = [[x + distance * (rand.random() - 0.5) for x in p] for p in distinct]
+  return points + copies
+
+
+def load(file):
+  # File format :
+  # dimension \n number of points \n points coordinates
+  data = file.read().split()
+  n = int(data[1])
+  return [[float(x) for x in data[2 + 3 * i:5 + 3 * i]] for i in range(n)]
+
+
+def save(points, file):
+  file.write('3 \n')
+  file.write('%s\n' % len(points))
+  data = ['%r %r %r\n' % (p[0], p[1], p[2]) for p in points]
+  file.write(''.join(data))
+
+if __name__ == '__main__':
+  import sys
+
+  if len(sys.argv) != 4:
+    print('Usage : %s in.cloud out.cloud distance' % sys.argv[0])
+    sys.exit(1)
+
+  with open(sys.argv[1], 'r') as f:
+    points = load(f)
+  with open(sys.argv[2], 'w') as f:
+    save(jitter(points, float(sys.argv[3])), f)
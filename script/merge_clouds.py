@@ -0,0 +1,21 @@
+#!/usr/bin/env python
+
+from fill_cloud import Cloud
+
+if __name__ == '__main__':
+  import sys
+
+  if len(sys.argv) < 3:
+    print('Usage : %s out.cloud in.cloud [in.cloud ...]' % sys.argv[0])
+    sys.exit(1)
+
+  # the points of the clouds one after the other
+  points = []
+  for name in sys.argv[2:]:
+    cloud = Cloud([])
+    with open(name, 'r') as f:
+      cloud.load(f)
+    points += cloud._points
+
+  with open(sys.argv[1], 'w') as f:
+    Cloud(points).save(f)
@@ -0,0 +1,33 @@
+#!/usr/bin/env python
+
+import math
+
+
+def sphere(n, radius=1.):
+  "n points evenly spread on a sphere (Fibonacci lattice), always the same ones."
+  golden = math.pi * (3. - math.sqrt(5.))
+  points = []
+  for i in range(n):
+    z = 1. - (2. * i + 1.) / n
+    rho = math.sqrt(1. - z * z)
+    theta = golden * i
+    points.append([radius * rho * math.cos(theta), radius * rho * math.sin(theta), radius * z])
+  return points
+
+
+def save(points, file):
+  file.write('3 \n')
+  file.write('%s\n' % len(points))
+  data = ['%r %r %r\n' % (p[0], p[1], p[2]) for p in points]
+  file.write(''.join(data))
+
+if __name__ == '__main__':
+  import sys
+
+  if len(sys.argv) not in (3, 4):
+    print('Usage : %s out.cloud number_of_points [radius]' % sys.argv[0])
+    sys.exit(1)
+
+  radius = float(sys.argv[3]) if len(sys.argv) == 4 else 1.
+  with open(sys.argv[1], 'w') as f:
+    save(sphere(int(sys.argv[2]), radius), f)